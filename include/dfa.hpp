@@ -19,6 +19,7 @@ namespace lexer0 {
 
     class dfa {
         friend class nfa;
+        friend class fused_dfa;
     private:
         // status size
         size_type size;
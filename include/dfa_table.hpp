@@ -0,0 +1,132 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+#include "dfa.hpp"
+
+namespace lexer0 {
+
+    class fused_dfa;
+
+    /**
+     * Transition table of a <code>fused_dfa</code> over input bytes. The
+     * bytes are first mapped to classes of bytes leading to the same
+     * status everywhere, then the table is stored in one of the layouts
+     * <ul>
+     *  <li>dense: <code>[status][class]</code> array</li>
+     *  <li>comb: the rows are packed into a shared array with row
+     *  displacement, every slot checked against its status, and the most
+     *  common target of a row is left out as the default</li>
+     * </ul>
+     */
+    class dfa_table {
+    public:
+        enum class layout {
+            dense, comb
+        };
+
+        // the missing transition
+        static constexpr std::uint32_t dead = UINT32_MAX;
+        // the status without accepting rule
+        static constexpr std::uint32_t no_accept = UINT32_MAX;
+
+    private:
+        layout table_layout{layout::dense};
+        std::size_t class_size{0};
+        std::array<std::uint8_t, 256> byte_class{};
+
+        // dense layout, status * class_size + class
+        std::vector<std::uint32_t> dense_next;
+
+        // comb layout
+        std::vector<std::uint32_t> row_base;
+        std::vector<std::uint32_t> row_default;
+        std::vector<std::uint32_t> comb_next;
+        std::vector<std::uint32_t> comb_check;
+
+        // the rule accepted, no_accept if none
+        std::vector<std::uint32_t> accept_reg;
+        std::vector<bool> trap_status;
+        std::uint32_t ini_status{0};
+        // number of transitions differing from the default of their rows
+        std::size_t non_default_size{0};
+
+        /* the statuses looping on themselves over a set of bytes, a run of
+            those bytes is skipped at once instead of byte by byte */
+        static constexpr std::uint32_t no_loop = UINT32_MAX;
+        // index of the loop of every status, no_loop if none
+        std::vector<std::uint32_t> loop_ix;
+        // bit set of the looping bytes
+        std::vector<std::array<std::uint64_t, 4>> loop_set;
+        // the only byte leaving the loop, found by memchr, -1 if there are several
+        std::vector<int> loop_exit;
+
+        // the end of the run of looping bytes from from_ix
+        [[nodiscard]] std::size_t skip_loop(std::string_view sv, std::size_t from_ix, std::uint32_t l) const;
+
+        // the transitions of every status on every class
+        std::vector<std::vector<std::uint32_t>> build_rows(const fused_dfa &fa);
+
+        void build_dense(const std::vector<std::vector<std::uint32_t>> &rows);
+
+        void build_comb(const std::vector<std::vector<std::uint32_t>> &rows);
+
+    public:
+        dfa_table() = default;
+
+        /**
+         * Build the table in the layout chosen by the density of the
+         * transitions: dense when the table is small or its rows are
+         * mostly non-default, comb otherwise.
+         */
+        explicit dfa_table(const fused_dfa &fa);
+
+        /**
+         * Build the table in the designated layout
+         */
+        dfa_table(const fused_dfa &fa, layout l);
+
+        /**
+         * Get the status after status <code>s</code> on the byte, dead if none
+         */
+        [[nodiscard]] std::uint32_t next(std::uint32_t s, unsigned char c) const {
+            std::uint32_t cls = byte_class[c];
+            if (table_layout == layout::dense) {
+                return dense_next[s * class_size + cls];
+            }
+            std::size_t ix = row_base[s] + cls;
+            return comb_check[ix] == s ? comb_next[ix] : row_default[s];
+        }
+
+        /**
+         * Find the longest prefix of <code>sv</code> starting at <code>start_ix</code>,
+         * as <code>fused_dfa::longest_match</code> does.
+         * @return The matching rule and the length of the match, the rule is
+         * fused_dfa::npos if no non-empty prefix is accepted
+         */
+        [[nodiscard]] std::tuple<std::size_t, std::size_t> longest_match(std::string_view sv,
+                                                                         std::size_t start_ix) const;
+
+        [[nodiscard]] layout get_layout() const;
+        /**
+         * Get the number of byte classes
+         */
+        [[nodiscard]] std::size_t classes() const;
+        /**
+         * Get the size of the transition table in bytes, byte classes included
+         */
+        [[nodiscard]] std::size_t table_bytes() const;
+        /**
+         * Get the ratio of the non-default transitions to the table entries
+         */
+        [[nodiscard]] double density() const;
+
+        [[nodiscard]] std::string to_string() const;
+    };
+
+}
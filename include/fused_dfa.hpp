@@ -0,0 +1,142 @@
+#pragma once
+
+#include <vector>
+#include <map>
+#include <set>
+#include <string>
+#include <string_view>
+#include <limits>
+#include <tuple>
+#include <cstdint>
+#include <iosfwd>
+
+#include "dfa.hpp"
+#include "dfa_table.hpp"
+
+namespace lexer0 {
+
+    /**
+     * Product automaton of the DFAs of a lexer. Every status stands for a
+     * tuple of statuses of the component DFAs, so one transition replaces
+     * one <code>dfa::trans_on</code> call per rule. Unlike <code>dfa</code>
+     * it carries no current status and may be shared between callers.
+     */
+    class fused_dfa {
+    public:
+        // marks the status without accepting rule, or the missing transition
+        static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+    private:
+        // status size
+        size_type size;
+        // initial status
+        status_type ini_status;
+
+        // input code seen by any of the component DFAs
+        std::set<input_type> registered_input;
+
+        // transition edge for every status on designated input
+        std::vector<std::map<input_type, status_type>> trans;
+        /* the rule accepted at the status, the rule designated first
+            wins when several rules accept, npos if none accepts */
+        std::vector<std::size_t> accept_reg;
+        /* indicating whether there is no possible path from the
+            status to any accepting status */
+        std::vector<bool> trap_status;
+
+        // transition table over bytes, walked by longest_match
+        dfa_table table;
+
+        // merge the statuses that can not be told apart
+        void minimize();
+
+    public:
+        /**
+         * Fuse the DFAs, the former DFA has the higher priority
+         * when several of them accept the same input.
+         * @param fas The DFAs of the rules, in priority order
+         */
+        explicit fused_dfa(const std::vector<dfa> &fas);
+
+        /**
+         * Get the number of statuses
+         */
+        [[nodiscard]] size_type status_size() const;
+        /**
+         * Get the initial status
+         */
+        [[nodiscard]] status_type initial_status() const;
+        /**
+         * Get the input codes seen by the automaton
+         */
+        [[nodiscard]] const std::set<input_type> &inputs() const;
+        /**
+         * Get the transitions leaving status <code>s</code>
+         */
+        [[nodiscard]] const std::map<input_type, status_type> &trans_of(status_type s) const;
+        /**
+         * Get the rule accepted at status <code>s</code>, npos if none
+         */
+        [[nodiscard]] std::size_t accept_of(status_type s) const;
+        /**
+         * Is there no possible path from status <code>s</code> to any accepting status
+         */
+        [[nodiscard]] bool trap_of(status_type s) const;
+
+        /**
+         * Get the transition table over bytes, its layout is chosen by the density
+         */
+        [[nodiscard]] const dfa_table &get_table() const;
+
+        /**
+         * Find the longest prefix of <code>sv</code> starting at <code>start_ix</code>
+         * accepted by any rule. At least one character is consumed.
+         * @param sv Input
+         * @param start_ix Beginning of the match
+         * @return The matching rule and the length of the match, the rule is
+         * npos if no non-empty prefix is accepted
+         */
+        [[nodiscard]] std::tuple<std::size_t, std::size_t> longest_match(std::string_view sv,
+                                                                         std::size_t start_ix) const;
+
+        /**
+         * Count the visits of every status while lexing the corpus, the
+         * profile for <code>hot_order</code>.
+         * @param corpus Training input
+         * @return Visit count of every status
+         */
+        [[nodiscard]] std::vector<std::uint64_t> profile(std::string_view corpus) const;
+        /**
+         * Get a layout of the statuses, the hottest status not placed yet
+         * is followed by its hottest successor not placed yet, and so on,
+         * so that the hot paths occupy adjacent rows of the table. The
+         * initial status goes first.
+         * @param visits Visit count of every status, see <code>profile</code>
+         * @return The status placed at every position
+         */
+        [[nodiscard]] std::vector<status_type> hot_order(const std::vector<std::uint64_t> &visits) const;
+        /**
+         * Renumber the statuses, status <code>order[i]</code> becomes status
+         * <code>i</code>, and rebuild the table.
+         * @param order The status placed at every position, a permutation
+         */
+        void reorder(const std::vector<status_type> &order);
+
+        /**
+         * Save the layout, to be loaded with <code>read_order</code> and applied
+         * with <code>reorder</code> to the automaton of the same rules
+         */
+        static void write_order(std::ostream &os, const std::vector<status_type> &order);
+        /**
+         * Load the layout saved by <code>write_order</code>
+         */
+        static std::vector<status_type> read_order(std::istream &is);
+
+        /**
+         * Get the description
+         * @return description
+         */
+        [[nodiscard]] std::string to_string() const;
+    };
+
+}
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <iterator>
+#include <optional>
+#include <utility>
+
+namespace lexer0 {
+
+    /**
+     * Coroutine yielding values of type T lazily, one at a time, to a
+     * range-for loop. The coroutine runs only when the next value is
+     * asked for and is destroyed with the generator, so the consumer may
+     * stop at any time.
+     */
+    template<typename T>
+    class generator {
+    public:
+        struct promise_type {
+            std::optional<T> value;
+            std::exception_ptr exception;
+
+            generator get_return_object();
+
+            std::suspend_always initial_suspend() noexcept { return {}; }
+
+            std::suspend_always final_suspend() noexcept { return {}; }
+
+            std::suspend_always yield_value(T v);
+
+            void return_void() {}
+
+            void unhandled_exception() { exception = std::current_exception(); }
+        };
+
+        using handle_type = std::coroutine_handle<promise_type>;
+
+        class iterator {
+            friend class generator;
+        private:
+            handle_type handle;
+
+            explicit iterator(handle_type h);
+
+            // resume the coroutine until the next value or the end
+            void advance();
+
+        public:
+            using iterator_category = std::input_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+
+            iterator() = default;
+
+            T &operator*() const;
+
+            iterator &operator++();
+
+            void operator++(int);
+
+            friend bool operator==(const iterator &it, std::default_sentinel_t) {
+                return !it.handle || it.handle.done();
+            }
+        };
+
+        explicit generator(handle_type h);
+
+        generator(generator &&other) noexcept;
+
+        generator &operator=(generator &&other) noexcept;
+
+        generator(const generator &) = delete;
+
+        generator &operator=(const generator &) = delete;
+
+        ~generator();
+
+        /**
+         * Start the coroutine, run it until the first value
+         */
+        iterator begin();
+
+        [[nodiscard]] std::default_sentinel_t end() const;
+
+    private:
+        handle_type handle;
+    };
+
+    template<typename T>
+    generator<T> generator<T>::promise_type::get_return_object() {
+        return generator{handle_type::from_promise(*this)};
+    }
+
+    template<typename T>
+    std::suspend_always generator<T>::promise_type::yield_value(T v) {
+        value = std::move(v);
+        return {};
+    }
+
+    template<typename T>
+    generator<T>::iterator::iterator(handle_type h) : handle{h} {
+    }
+
+    template<typename T>
+    void generator<T>::iterator::advance() {
+        handle.promise().value.reset();
+        handle.resume();
+        if (handle.promise().exception) {
+            std::rethrow_exception(std::exchange(handle.promise().exception, nullptr));
+        }
+    }
+
+    template<typename T>
+    T &generator<T>::iterator::operator*() const {
+        return *handle.promise().value;
+    }
+
+    template<typename T>
+    typename generator<T>::iterator &generator<T>::iterator::operator++() {
+        advance();
+        return *this;
+    }
+
+    template<typename T>
+    void generator<T>::iterator::operator++(int) {
+        advance();
+    }
+
+    template<typename T>
+    generator<T>::generator(handle_type h) : handle{h} {
+    }
+
+    template<typename T>
+    generator<T>::generator(generator &&other) noexcept : handle{std::exchange(other.handle, nullptr)} {
+    }
+
+    template<typename T>
+    generator<T> &generator<T>::operator=(generator &&other) noexcept {
+        if (this != &other) {
+            if (handle) {
+                handle.destroy();
+            }
+            handle = std::exchange(other.handle, nullptr);
+        }
+        return *this;
+    }
+
+    template<typename T>
+    generator<T>::~generator() {
+        if (handle) {
+            handle.destroy();
+        }
+    }
+
+    template<typename T>
+    typename generator<T>::iterator generator<T>::begin() {
+        iterator it{handle};
+        if (handle && !handle.done()) {
+            it.advance();
+        }
+        return it;
+    }
+
+    template<typename T>
+    std::default_sentinel_t generator<T>::end() const {
+        return std::default_sentinel;
+    }
+
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "fused_dfa.hpp"
+
+namespace lexer0 {
+
+    /**
+     * Generate the C++ source of a direct-coded lexer, every status of the
+     * automaton becomes a labeled block branching on the input with a
+     * <code>switch</code>, so no transition table is consulted. The function
+     * generated has the signature
+     * <code>std::vector<lexer0::token> func_name(const std::string &)</code>
+     * and produces the same tokens as <code>t_lexer::lexer</code>.
+     * @param fa The fused automaton of the lexer
+     * @param func_name Name of the function generated
+     * @param skip_regs Whether the tokens of every rule are dropped, see
+     * <code>t_lexer::skip_flags</code>, empty if none is
+     * @return The C++ source
+     */
+    std::string generate_direct_lexer(const fused_dfa &fa, const std::string &func_name,
+                                      const std::vector<bool> &skip_regs = {});
+
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+namespace lexer0 {
+
+    /**
+     * Index of the line starts of an input, mapping the offsets of the
+     * tokens to (line, column) in <code>O(log n)</code>, both zero-based,
+     * the column in bytes. The input may arrive in chunks, and the bytes
+     * are scanned for newlines lazily, only up to the offset queried, so
+     * an index never queried costs nothing but its construction.
+     * The latest chunk is referenced, not copied, and must stay alive
+     * until the next chunk is appended. The earlier chunks are all
+     * scanned and no longer referenced.
+     */
+    class line_index {
+    private:
+        // offset of the first byte of every line, line_start[0] == 0
+        std::vector<std::size_t> line_start{0};
+        // the latest chunk, and its offset in the input
+        std::string_view chunk;
+        std::size_t chunk_offset{0};
+        // bytes of the latest chunk scanned
+        std::size_t scanned{0};
+
+        void scan_to(std::size_t chunk_ix);
+
+    public:
+        line_index() = default;
+
+        /**
+         * Create the index of the input
+         * @param sv Input, the buffer passed to the lexer
+         */
+        explicit line_index(std::string_view sv);
+
+        /**
+         * Append the next chunk of the input, scanning the rest of the
+         * previous one
+         * @param next_chunk Chunk
+         */
+        void append(std::string_view next_chunk);
+
+        /**
+         * Get the line and the column of the offset, scanning the input up
+         * to it if not yet scanned
+         * @param offset Offset in the input, at most <code>size()</code>
+         * @return (line, column)
+         */
+        std::tuple<std::size_t, std::size_t> position(std::size_t offset);
+
+        /**
+         * Get the number of bytes of the input appended
+         */
+        [[nodiscard]] std::size_t size() const;
+    };
+
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+namespace lexer0 {
+
+    /**
+     * Decode the token matched by <code>t_integer_reg</code>: decimal, octal
+     * with the leading <code>0</code>, or hexadecimal with <code>0x</code>/<code>0X</code>.
+     * @param sv Token
+     * @param value Decoded value
+     * @return false if the value overflows
+     */
+    bool decode_integer(std::string_view sv, std::uint64_t &value);
+
+    /**
+     * Decode the token matched by <code>t_float_reg</code>, the value of a
+     * token with the <code>f</code>/<code>F</code> suffix is rounded to float.
+     * Up to 19 significant digits are gathered in one pass, and the value is
+     * exact whenever the digits and the power of ten are both exact in the
+     * floating-point type. Otherwise the correctly rounded
+     * <code>std::from_chars</code> decodes the token.
+     * @param sv Token
+     * @param value Decoded value
+     * @return false if the token is malformed
+     */
+    bool decode_float(std::string_view sv, double &value);
+
+}
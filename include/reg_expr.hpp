@@ -4,6 +4,7 @@
 #include <cassert>
 
 #include "nfa.hpp"
+#include "utf8_range.hpp"
 
 namespace lexer0 {
 
@@ -49,6 +50,25 @@ namespace lexer0 {
     };
 
 
+    class utf8_range_expr : public virtual reg_expr {
+    public:
+        char32_t lo_codepoint{0}, hi_codepoint{0};
+
+        /**
+         * Codepoints in <code>[lo, hi]</code>, recognized on the UTF-8
+         * encoded bytes
+         * @param lo The first codepoint
+         * @param hi The last codepoint
+         */
+        utf8_range_expr(char32_t lo, char32_t hi);
+
+        [[nodiscard]] std::size_t get_size(bool force) override;
+
+    protected:
+        void create_nfa(nfa &fa, std::size_t zero_status) const override;
+    };
+
+
     class repeat_expr : public virtual reg_expr {
     public:
         explicit repeat_expr(reg_expr *item);
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+#include "token.hpp"
+
+namespace lexer0 {
+
+    /**
+     * Symbol table mapping names to dense ids <code>0, 1, 2, ...</code> in
+     * the order of interning. The names are kept in an open-addressing
+     * table of (hash, id) slots probed linearly, and their bytes are
+     * stored once in blocks which are never moved, so every name returned
+     * stays valid as long as the table.
+     */
+    class symbol_table {
+    private:
+        struct slot {
+            std::uint32_t hash;
+            symbol_type id;
+        };
+
+        static constexpr std::size_t block_size = 4096;
+
+        // power of 2 slots, at most half of them are used
+        std::vector<slot> slots;
+        // name of every id
+        std::vector<std::string_view> names;
+        // storage of the names
+        std::vector<std::unique_ptr<char[]>> blocks;
+        // block the short names are appended to
+        char *curr_block{nullptr};
+        std::size_t block_used{block_size};
+
+        void grow();
+
+        std::string_view store(std::string_view name);
+
+    public:
+        /**
+         * Create a table
+         * @param capacity Number of names expected
+         */
+        explicit symbol_table(std::size_t capacity = 64);
+
+        /**
+         * Hash of the name, FNV-1a
+         */
+        static std::uint32_t hash_of(std::string_view name);
+
+        /**
+         * Get the id of the name, interning it if unseen
+         * @param name Name
+         * @return Dense id
+         */
+        symbol_type intern(std::string_view name);
+        /**
+         * Get the id of the name, interning it if unseen
+         * @param name Name
+         * @param hash <code>hash_of(name)</code>
+         * @return Dense id
+         */
+        symbol_type intern(std::string_view name, std::uint32_t hash);
+        /**
+         * Get the id of the name
+         * @return Dense id, no_symbol if the name is never interned
+         */
+        [[nodiscard]] symbol_type find(std::string_view name) const;
+        /**
+         * Get the name of the id
+         */
+        [[nodiscard]] std::string_view name_of(symbol_type id) const;
+        /**
+         * Get the number of names interned
+         */
+        [[nodiscard]] std::size_t size() const;
+    };
+
+    /**
+     * Symbol table shared by threads. The names are spread over shards by
+     * their hash, each a <code>symbol_table</code> under its own lock, and
+     * the ids stay dense over all the shards. <code>name_of</code> takes
+     * no lock.
+     */
+    class concurrent_symbol_table {
+    private:
+        static constexpr std::size_t shard_bits = 4;
+
+        struct shard {
+            std::mutex mutex;
+            symbol_table table;
+            // global id of every id in the shard table
+            std::vector<symbol_type> global_id;
+        };
+
+        std::array<shard, 1 << shard_bits> shards;
+        std::atomic<symbol_type> next_id{0};
+
+        /* name of every global id, chunk k holds the 2^k ids from 2^k - 1,
+            so that the chunks are never moved once allocated */
+        std::array<std::atomic<std::string_view *>, 32> names;
+
+    public:
+        concurrent_symbol_table();
+
+        ~concurrent_symbol_table();
+
+        concurrent_symbol_table(const concurrent_symbol_table &) = delete;
+
+        concurrent_symbol_table &operator=(const concurrent_symbol_table &) = delete;
+
+        /**
+         * Get the id of the name, interning it if unseen
+         * @param name Name
+         * @return Dense id
+         */
+        symbol_type intern(std::string_view name);
+        /**
+         * Get the name of the id, the id must be returned by <code>intern</code>
+         */
+        [[nodiscard]] std::string_view name_of(symbol_type id) const;
+        /**
+         * Get the number of names interned
+         */
+        [[nodiscard]] std::size_t size() const;
+    };
+
+}
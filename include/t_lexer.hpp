@@ -1,7 +1,17 @@
 #pragma once
 
+#include <algorithm>
+#include <span>
+#include <numeric>
+#include <type_traits>
+
 #include "t_reg_expr.hpp"
+#include "fused_dfa.hpp"
+#include "generator.hpp"
+#include "number_decoder.hpp"
+#include "thread_pool.hpp"
 #include "token.hpp"
+#include "token_batch.hpp"
 
 namespace lexer0 {
 
@@ -9,19 +19,137 @@ namespace lexer0 {
     class t_lexer {
         static_assert(sizeof...(Regs) > 0, "More than zero regex-es should be designated.");
     private:
+        // whether the tokens of the rule are skipped, see t_skip
+        static constexpr bool skip_reg[] = {t_is_skip<Regs>::value...};
+        // the kind of the value decoded from the tokens of the rule
+        static constexpr number_kind number_reg[] = {t_number_kind_of<Regs>...};
+
         std::vector<dfa> reg_vector;
+        // product automaton of reg_vector, stateless and shared by the batch lexing
+        fused_dfa fused;
+
+        // append the tokens of sv to the batch as a new input
+        void lexer_into(std::string_view sv, token_batch &batch) const;
 
     public:
         t_lexer();
 
         std::vector<token> lexer(const std::string& sv);
 
+        /**
+         * Lex the input and intern the tokens of the designated rules, the
+         * symbol id is stored in <code>token::token_symbol</code> and the
+         * <code>token::token_string</code> of an interned token is left
+         * empty, as its name is kept once by the table, see <code>name_of</code>.
+         * @param sv Input
+         * @param symbols Symbol table, <code>symbol_table</code> or
+         * <code>concurrent_symbol_table</code>
+         * @param interned_ids The rules whose tokens are interned, see <code>index_of</code>
+         * @return Tokens
+         */
+        template<typename Table>
+        std::vector<token> lexer(const std::string& sv, Table &symbols,
+                                 const std::vector<std::size_t> &interned_ids) const;
+
+        /**
+         * Lex the input and emit only the tokens of the designated rules, no
+         * token is built for the others. The runs of bytes on which the
+         * automaton loops, such as blanks or comments, are skipped at once.
+         * @param sv Input
+         * @param kept_ids The rules whose tokens are emitted, see <code>index_of</code>
+         * @return Tokens
+         */
+        [[nodiscard]] std::vector<token> lexer_filtered(const std::string& sv,
+                                                        const std::vector<std::size_t> &kept_ids) const;
+
+        /**
+         * Lex the input and decode the value of the tokens of
+         * <code>t_float_reg</code> and the integer rules into
+         * <code>token::token_number</code>, right after the token is
+         * matched while its bytes are still in cache. Integers that
+         * overflow are left undecoded.
+         * @param sv Input
+         * @return Tokens
+         */
+        [[nodiscard]] std::vector<token> lexer_with_values(const std::string& sv) const;
+
+        /**
+         * Get the token id of the rule, the first one if designated more than once
+         */
+        template<typename Reg>
+        static constexpr std::size_t index_of();
+
+        /**
+         * Lex the input lazily, a token is produced only when the consumer
+         * asks for the next one, so lexing stops as soon as the consumer
+         * does. The input must outlive the generator.
+         * @param sv Input
+         * @return Generator of the tokens
+         */
+        [[nodiscard]] generator<token> lexer_lazy(std::string_view sv) const;
+
+        /**
+         * Lex a batch of inputs at once, the tokens are stored in one
+         * struct-of-arrays result instead of a token vector per input.
+         * @param svs Inputs
+         * @return Tokens of all the inputs
+         */
+        [[nodiscard]] token_batch lexer_batch(std::span<const std::string> svs) const;
+
+        /**
+         * Lex a batch of inputs at once on the threads of the pool. The
+         * inputs are cut into chunks of about the same number of bytes, an
+         * input longer than that is a chunk of its own, and the threads
+         * take the chunks one by one, the largest first, so a few long
+         * inputs do not stall the other threads.
+         * @param svs Inputs
+         * @param pool Threads
+         * @return Tokens of all the inputs
+         */
+        [[nodiscard]] token_batch lexer_batch(std::span<const std::string> svs, thread_pool &pool) const;
+
+        /**
+         * Get whether the tokens of every rule are dropped, as designated by <code>t_skip</code>
+         * @return Flag of every rule, by token id
+         */
+        [[nodiscard]] static std::vector<bool> skip_flags();
+
+        /**
+         * Get the product automaton of all the rules, the former rule has
+         * the higher priority as it does in <code>lexer</code>.
+         * @return Fused automaton
+         */
+        [[nodiscard]] fused_dfa get_fused() const;
+
+        /**
+         * Renumber the statuses of the fused automaton used by the lexers,
+         * for instance by the layout <code>fused_dfa::hot_order</code> of a
+         * profile, saved and loaded along with the lexer.
+         * @param order The status placed at every position, a permutation
+         */
+        void reorder(const std::vector<status_type> &order);
+
         std::string to_string();
     };
 
     template<typename... Regs>
-    t_lexer<Regs...>::t_lexer() {
-        (reg_vector.push_back(t_get_nfa<Regs>().get_dfa().get_optimize()), ..., 0);
+    t_lexer<Regs...>::t_lexer()
+            : reg_vector{t_get_nfa<Regs>().get_dfa().get_optimize()...}, fused{reg_vector} {
+    }
+
+    template<typename... Regs>
+    fused_dfa t_lexer<Regs...>::get_fused() const {
+        return fused;
+    }
+
+    template<typename... Regs>
+    std::vector<bool> t_lexer<Regs...>::skip_flags() {
+        return std::vector<bool>(std::begin(skip_reg), std::end(skip_reg));
+    }
+
+    template<typename... Regs>
+    void t_lexer<Regs...>::reorder(const std::vector<status_type> &order) {
+        fused.reorder(order);
     }
 
     template<typename... Regs>
@@ -42,7 +170,9 @@ namespace lexer0 {
             do {
                 all_trap = true;
                 for (std::size_t r_reg_ix = 0; r_reg_ix < reg_vector.size(); ++r_reg_ix) {
-                    auto [acc, trap] = reg_vector.at(reg_vector.size() - r_reg_ix - 1).trans_on(sv.at(curr_ix));
+                    // feed raw bytes, so that the UTF-8 encoded input is never sign extended
+                    auto [acc, trap] = reg_vector.at(reg_vector.size() - r_reg_ix - 1)
+                            .trans_on(static_cast<unsigned char>(sv.at(curr_ix)));
                     reg_match |= acc;
                     all_trap &= trap;
                     if (acc) {
@@ -54,11 +184,13 @@ namespace lexer0 {
             } while (!all_trap && curr_ix < sv.size());
 
             if (reg_match) {
-                token_stream.push_back(
-                        token{recent_match_reg,
-                              start_ix,
-                              recent_match_ix - start_ix + 1,
-                              sv.substr(start_ix, recent_match_ix - start_ix + 1)});
+                if (!skip_reg[recent_match_reg]) {
+                    token_stream.push_back(
+                            token{recent_match_reg,
+                                  start_ix,
+                                  recent_match_ix - start_ix + 1,
+                                  sv.substr(start_ix, recent_match_ix - start_ix + 1)});
+                }
                 start_ix = curr_ix = recent_match_ix + 1;
                 for (auto &dfa : reg_vector) {
                     dfa.reset();
@@ -71,4 +203,199 @@ namespace lexer0 {
         return token_stream;
     }
 
+    template<typename... Regs>
+    template<typename Table>
+    std::vector<token> t_lexer<Regs...>::lexer(const std::string& sv, Table &symbols,
+                                               const std::vector<std::size_t> &interned_ids) const {
+        std::vector<bool> interned(sizeof...(Regs), false);
+        for (auto reg: interned_ids) {
+            interned.at(reg) = true;
+        }
+
+        std::size_t start_ix{0};
+        std::vector<token> token_stream;
+        while (start_ix < sv.size()) {
+            auto [reg, length] = fused.longest_match(sv, start_ix);
+            if (reg == fused_dfa::npos) {
+                break;
+            }
+            if (!skip_reg[reg]) {
+                std::string_view token_view{sv.data() + start_ix, length};
+                if (interned[reg]) {
+                    token_stream.push_back(token{reg, start_ix, length, std::string{}});
+                    token_stream.back().token_symbol = symbols.intern(token_view);
+                } else {
+                    token_stream.push_back(token{reg, start_ix, length, std::string{token_view}});
+                }
+            }
+            start_ix += length;
+        }
+        return token_stream;
+    }
+
+    template<typename... Regs>
+    std::vector<token> t_lexer<Regs...>::lexer_filtered(const std::string& sv,
+                                                        const std::vector<std::size_t> &kept_ids) const {
+        std::vector<bool> kept(sizeof...(Regs), false);
+        for (auto reg: kept_ids) {
+            kept.at(reg) = !skip_reg[reg];
+        }
+
+        std::size_t start_ix{0};
+        std::vector<token> token_stream;
+        while (start_ix < sv.size()) {
+            auto [reg, length] = fused.longest_match(sv, start_ix);
+            if (reg == fused_dfa::npos) {
+                break;
+            }
+            if (kept[reg]) {
+                token_stream.push_back(token{reg, start_ix, length, sv.substr(start_ix, length)});
+            }
+            start_ix += length;
+        }
+        return token_stream;
+    }
+
+    template<typename... Regs>
+    std::vector<token> t_lexer<Regs...>::lexer_with_values(const std::string& sv) const {
+        std::size_t start_ix{0};
+        std::vector<token> token_stream;
+        while (start_ix < sv.size()) {
+            auto [reg, length] = fused.longest_match(sv, start_ix);
+            if (reg == fused_dfa::npos) {
+                break;
+            }
+            if (!skip_reg[reg]) {
+                std::string_view token_view{sv.data() + start_ix, length};
+                token_stream.push_back(token{reg, start_ix, length, std::string{token_view}});
+                if (number_reg[reg] == number_kind::integer) {
+                    if (std::uint64_t value; decode_integer(token_view, value)) {
+                        token_stream.back().token_number = value;
+                    }
+                } else if (number_reg[reg] == number_kind::floating) {
+                    if (double value; decode_float(token_view, value)) {
+                        token_stream.back().token_number = value;
+                    }
+                }
+            }
+            start_ix += length;
+        }
+        return token_stream;
+    }
+
+    template<typename... Regs>
+    template<typename Reg>
+    constexpr std::size_t t_lexer<Regs...>::index_of() {
+        static_assert((std::is_same_v<Reg, Regs> || ...), "The rule is not designated.");
+        constexpr bool same[] = {std::is_same_v<Reg, Regs>...};
+        std::size_t ix = 0;
+        while (!same[ix]) {
+            ++ix;
+        }
+        return ix;
+    }
+
+    template<typename... Regs>
+    generator<token> t_lexer<Regs...>::lexer_lazy(std::string_view sv) const {
+        std::size_t start_ix{0};
+        while (start_ix < sv.size()) {
+            auto [reg, length] = fused.longest_match(sv, start_ix);
+            if (reg == fused_dfa::npos) {
+                break;
+            }
+            if (!skip_reg[reg]) {
+                // a named token, GCC mishandles the temporaries alive across co_yield
+                token t{reg, start_ix, length, std::string{sv.substr(start_ix, length)}};
+                co_yield std::move(t);
+            }
+            start_ix += length;
+        }
+    }
+
+    template<typename... Regs>
+    void t_lexer<Regs...>::lexer_into(std::string_view sv, token_batch &batch) const {
+        std::size_t start_ix{0};
+        while (start_ix < sv.size()) {
+            auto [reg, length] = fused.longest_match(sv, start_ix);
+            if (reg == fused_dfa::npos) {
+                break;
+            }
+            if (!skip_reg[reg]) {
+                batch.token_id.push_back(reg);
+                batch.token_start.push_back(start_ix);
+                batch.token_length.push_back(length);
+            }
+            start_ix += length;
+        }
+        batch.input_start.push_back(batch.token_id.size());
+    }
+
+    template<typename... Regs>
+    token_batch t_lexer<Regs...>::lexer_batch(std::span<const std::string> svs) const {
+        token_batch batch;
+        for (auto &sv: svs) {
+            lexer_into(sv, batch);
+        }
+        return batch;
+    }
+
+    template<typename... Regs>
+    token_batch t_lexer<Regs...>::lexer_batch(std::span<const std::string> svs, thread_pool &pool) const {
+        // bytes of a chunk, an input counts one more byte so that the empty inputs are bounded too
+        constexpr std::size_t chunk_bytes = 16 * 1024;
+
+        std::vector<std::size_t> chunk_start{0}, chunk_size;
+        std::size_t bytes = 0;
+        for (std::size_t sv_ix = 0; sv_ix < svs.size(); ++sv_ix) {
+            if (bytes > 0 && bytes + svs[sv_ix].size() + 1 > chunk_bytes) {
+                chunk_start.push_back(sv_ix);
+                chunk_size.push_back(bytes);
+                bytes = 0;
+            }
+            bytes += svs[sv_ix].size() + 1;
+        }
+        chunk_start.push_back(svs.size());
+        chunk_size.push_back(bytes);
+        const std::size_t chunk_count = chunk_size.size();
+
+        if (pool.thread_size() <= 1 || chunk_count <= 1) {
+            return lexer_batch(svs);
+        }
+
+        // the largest chunks are taken first, so the last ones taken are short
+        std::vector<std::size_t> chunk_order(chunk_count);
+        std::iota(chunk_order.begin(), chunk_order.end(), 0);
+        std::stable_sort(chunk_order.begin(), chunk_order.end(), [&](std::size_t l, std::size_t r) {
+            return chunk_size.at(l) > chunk_size.at(r);
+        });
+        std::vector<token_batch> chunk_batch(chunk_count);
+        pool.run(chunk_count, [&](std::size_t order_ix) {
+            std::size_t chunk_ix = chunk_order.at(order_ix);
+            for (std::size_t sv_ix = chunk_start.at(chunk_ix); sv_ix < chunk_start.at(chunk_ix + 1); ++sv_ix) {
+                lexer_into(svs[sv_ix], chunk_batch.at(chunk_ix));
+            }
+        });
+
+        // concatenate the chunks in order
+        token_batch batch;
+        std::size_t token_size = 0;
+        for (auto &cb: chunk_batch) {
+            token_size += cb.token_id.size();
+        }
+        batch.token_id.reserve(token_size);
+        batch.token_start.reserve(token_size);
+        batch.token_length.reserve(token_size);
+        batch.input_start.reserve(svs.size() + 1);
+        for (auto &cb: chunk_batch) {
+            std::size_t base = batch.token_id.size();
+            batch.token_id.insert(batch.token_id.end(), cb.token_id.begin(), cb.token_id.end());
+            batch.token_start.insert(batch.token_start.end(), cb.token_start.begin(), cb.token_start.end());
+            batch.token_length.insert(batch.token_length.end(), cb.token_length.begin(), cb.token_length.end());
+            for (std::size_t i = 1; i < cb.input_start.size(); ++i) {
+                batch.input_start.push_back(base + cb.input_start.at(i));
+            }
+        }
+        return batch;
+    }
+
 }
\ No newline at end of file
@@ -1,8 +1,10 @@
 #pragma once
 
 #include <functional>
+#include <type_traits>
 
 #include "nfa.hpp"
+#include "utf8_range.hpp"
 
 namespace lexer0 {
 
@@ -31,6 +33,64 @@ namespace lexer0 {
         return std::to_string(Termination);
     }
 
+    template<int Lo, int Hi>
+    class t_range_expr {
+        static_assert(Lo <= Hi, "Empty range.");
+    public:
+        static constexpr std::size_t get_size();
+
+        static void create_nfa(nfa &, status_type zero_status);
+
+        static std::string to_string();
+    };
+
+    template<int Lo, int Hi>
+    constexpr std::size_t t_range_expr<Lo, Hi>::get_size() {
+        return 2;
+    }
+
+    template<int Lo, int Hi>
+    void t_range_expr<Lo, Hi>::create_nfa(lexer0::nfa &fa, lexer0::status_type zero_status) {
+        for (input_type v = Lo; v <= Hi; ++v) {
+            fa.add_trans(zero_status, zero_status + 1, v);
+        }
+    }
+
+    template<int Lo, int Hi>
+    std::string t_range_expr<Lo, Hi>::to_string() {
+        return '[' + std::to_string(Lo) + '-' + std::to_string(Hi) + ']';
+    }
+
+    /**
+     * Codepoints in <code>[Lo, Hi]</code>, recognized on the UTF-8 encoded
+     * bytes, so the lexer runs on raw bytes without decoding.
+     */
+    template<char32_t Lo, char32_t Hi>
+    class t_utf8_range_expr {
+        static_assert(Lo <= Hi && Hi <= utf8_max_codepoint, "Invalid codepoint range.");
+    public:
+        static constexpr std::size_t get_size();
+
+        static void create_nfa(nfa &, status_type zero_status);
+
+        static std::string to_string();
+    };
+
+    template<char32_t Lo, char32_t Hi>
+    constexpr std::size_t t_utf8_range_expr<Lo, Hi>::get_size() {
+        return utf8_nfa_size(Lo, Hi);
+    }
+
+    template<char32_t Lo, char32_t Hi>
+    void t_utf8_range_expr<Lo, Hi>::create_nfa(lexer0::nfa &fa, lexer0::status_type zero_status) {
+        utf8_create_nfa(fa, zero_status, Lo, Hi);
+    }
+
+    template<char32_t Lo, char32_t Hi>
+    std::string t_utf8_range_expr<Lo, Hi>::to_string() {
+        return '[' + utf8_codepoint_name(Lo) + '-' + utf8_codepoint_name(Hi) + ']';
+    }
+
     template<typename Regex>
     class t_repeat_expr {
         using Check = decltype((Regex::get_size, Regex::create_nfa, int{}));
@@ -189,6 +249,23 @@ namespace lexer0 {
         return '(' + Regex::to_string() + ")?";
     }
 
+    /**
+     * Mark the rule as skipped, the lexer matches its tokens as usual but
+     * never emits them.
+     */
+    template<typename Regex>
+    class t_skip : public Regex {
+        using Check = decltype((Regex::get_size, Regex::create_nfa, int{}));
+    };
+
+    template<typename Reg>
+    struct t_is_skip : std::false_type {
+    };
+
+    template<typename Regex>
+    struct t_is_skip<t_skip<Regex>> : std::true_type {
+    };
+
     template<typename Reg>
     nfa t_get_nfa() {
         nfa ret{Reg::get_size()};
@@ -352,6 +429,23 @@ namespace lexer0 {
             t_exist_not_expr<t_or_expr<t_terminate_expr<'f'>, t_terminate_expr<'F'>>>
     >;
 
+    enum class number_kind {
+        none, integer, floating
+    };
+
+    // the kind of the value decoded from the tokens of the rule
+    template<typename Reg>
+    constexpr number_kind t_number_kind_of =
+            std::is_same_v<Reg, t_float_reg> ? number_kind::floating :
+            std::is_same_v<Reg, t_integer_reg> || std::is_same_v<Reg, t_dec_integer_reg> ||
+            std::is_same_v<Reg, t_oct_integer_reg> || std::is_same_v<Reg, t_hex_integer_reg> ? number_kind::integer :
+            number_kind::none;
+
+    using t_line_comment_reg = t_cat_expr<
+            t_terminate_expr<'/'>,
+            t_terminate_expr<'/'>,
+            t_repeat_expr<t_or_expr<t_range_expr<0, '\n' - 1>, t_range_expr<'\n' + 1, 255>>>>;
+
     using t_blank_reg = t_repeat_expr<t_or_expr<
             t_terminate_expr<' '>,
             t_terminate_expr<'\t'>,
@@ -362,4 +456,29 @@ namespace lexer0 {
             t_terminate_expr<'\b'>,
             t_terminate_expr<'\f'>
     >>;
+
+    // letters of the main non-ASCII scripts, an approximation of the Unicode letters
+    using t_utf8_letter_reg = t_or_expr<
+            t_utf8_range_expr<0x00C0, 0x00D6>,
+            t_utf8_range_expr<0x00D8, 0x00F6>,
+            t_utf8_range_expr<0x00F8, 0x02AF>,    // Latin-1, Latin Extended, IPA
+            t_utf8_range_expr<0x0370, 0x03FF>,    // Greek
+            t_utf8_range_expr<0x0400, 0x052F>,    // Cyrillic
+            t_utf8_range_expr<0x05D0, 0x05EA>,    // Hebrew
+            t_utf8_range_expr<0x0620, 0x064A>,    // Arabic
+            t_utf8_range_expr<0x3040, 0x30FF>,    // Hiragana, Katakana
+            t_utf8_range_expr<0x3400, 0x4DBF>,    // CJK Extension A
+            t_utf8_range_expr<0x4E00, 0x9FFF>,    // CJK
+            t_utf8_range_expr<0xAC00, 0xD7A3>>;   // Hangul
+
+    using t_utf8_identifier_reg = t_cat_expr<
+            t_or_expr<t_alpha_reg, t_Alpha_reg, t_terminate_expr<'_'>, t_utf8_letter_reg>,
+            t_repeat_expr<
+                    t_or_expr<
+                            t_dec_digit_reg,
+                            t_alpha_reg,
+                            t_Alpha_reg,
+                            t_terminate_expr<'_'>,
+                            t_utf8_letter_reg>>
+    >;
 }
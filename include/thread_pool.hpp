@@ -0,0 +1,65 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace lexer0 {
+
+    /**
+     * Fixed set of worker threads reused by every <code>run</code>, so no
+     * thread is created per call. The tasks of a run are claimed one at a
+     * time by the workers and the calling thread, so a thread done with a
+     * short task takes the next one instead of waiting. One run at a time.
+     */
+    class thread_pool {
+    private:
+        std::vector<std::jthread> workers;
+        std::mutex mutex;
+        std::condition_variable task_ready, task_done;
+
+        // the task of the current run, nullptr between the runs
+        const std::function<void(std::size_t)> *task{nullptr};
+        std::size_t task_size{0};
+        std::size_t next_ix{0};
+        // number of runs started, and of the workers inside the current run
+        std::size_t generation{0};
+        std::size_t busy{0};
+        bool stopping{false};
+
+        void work();
+
+        // run the tasks not claimed yet, returns with the lock held
+        void drain(std::unique_lock<std::mutex> &lock);
+
+    public:
+        /**
+         * Create a pool
+         * @param thread_size Number of threads including the calling one, 1 creates no worker
+         */
+        explicit thread_pool(std::size_t thread_size);
+
+        ~thread_pool();
+
+        thread_pool(const thread_pool &) = delete;
+
+        thread_pool &operator=(const thread_pool &) = delete;
+
+        /**
+         * Call <code>f(0), f(1), ..., f(size - 1)</code> on the threads of
+         * the pool, and wait for all of them
+         * @param size Number of tasks
+         * @param f Task
+         */
+        void run(std::size_t size, const std::function<void(std::size_t)> &f);
+
+        /**
+         * Get the number of threads including the calling one
+         */
+        [[nodiscard]] std::size_t thread_size() const;
+    };
+
+}
@@ -2,14 +2,29 @@
 
 #include <tuple>
 #include <string>
+#include <cstdint>
+#include <limits>
+#include <variant>
 
 namespace lexer0 {
 
+    // dense id of an interned symbol
+    using symbol_type = std::uint32_t;
+    // the token is not interned
+    constexpr symbol_type no_symbol = std::numeric_limits<symbol_type>::max();
+
+    // decoded value of a numeric token, std::monostate if not decoded
+    using number_type = std::variant<std::monostate, std::uint64_t, double>;
+
     struct token {
         std::size_t token_id;
         std::size_t token_start;
         std::size_t token_length;
         std::string token_string;
+        // id of token_string in the symbol table, if interned by the lexer
+        symbol_type token_symbol{no_symbol};
+        // value of the integer or floating token, if decoded by the lexer
+        number_type token_number{};
 
         [[nodiscard]] std::string to_string() const;
 
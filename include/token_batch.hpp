@@ -0,0 +1,23 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+namespace lexer0 {
+
+    /**
+     * Tokens of a batch of inputs in struct-of-arrays (CSR) layout, the
+     * tokens of input <code>i</code> are those at
+     * <code>[input_start[i], input_start[i + 1])</code>, so
+     * <code>input_start</code> holds one more entry than the inputs.
+     * No token string is stored, <code>token_start</code> is the offset
+     * of the token in its own input.
+     */
+    struct token_batch {
+        std::vector<std::size_t> token_id;
+        std::vector<std::size_t> token_start;
+        std::vector<std::size_t> token_length;
+        std::vector<std::size_t> input_start{0};
+    };
+
+}
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <array>
+#include <string>
+
+#include "nfa.hpp"
+
+namespace lexer0 {
+
+    /**
+     * UTF-8 encoding of a codepoint range whose codepoints share the same
+     * encoded length and differ only in a fixed set of trailing bytes. The
+     * range is recognized by the byte ranges <code>[lo, hi]</code> in order.
+     */
+    struct utf8_sequence {
+        std::size_t length{0};
+        std::array<unsigned char, 4> lo{};
+        std::array<unsigned char, 4> hi{};
+    };
+
+    /**
+     * The byte sequences recognizing a codepoint range, at most
+     * <code>capacity</code> of them are needed for any valid range.
+     */
+    struct utf8_sequences {
+        static constexpr std::size_t capacity = 32;
+
+        std::size_t count{0};
+        std::array<utf8_sequence, capacity> seqs{};
+    };
+
+    constexpr char32_t utf8_max_codepoint = 0x10FFFF;
+
+    /**
+     * Encode the codepoint in UTF-8
+     * @param cp Codepoint, surrogates excluded
+     * @param bytes Encoded bytes
+     * @return Encoded length
+     */
+    constexpr std::size_t utf8_encode(char32_t cp, std::array<unsigned char, 4> &bytes) {
+        if (cp <= 0x7F) {
+            bytes[0] = static_cast<unsigned char>(cp);
+            return 1;
+        } else if (cp <= 0x7FF) {
+            bytes[0] = static_cast<unsigned char>(0xC0 | (cp >> 6));
+            bytes[1] = static_cast<unsigned char>(0x80 | (cp & 0x3F));
+            return 2;
+        } else if (cp <= 0xFFFF) {
+            bytes[0] = static_cast<unsigned char>(0xE0 | (cp >> 12));
+            bytes[1] = static_cast<unsigned char>(0x80 | ((cp >> 6) & 0x3F));
+            bytes[2] = static_cast<unsigned char>(0x80 | (cp & 0x3F));
+            return 3;
+        } else {
+            bytes[0] = static_cast<unsigned char>(0xF0 | (cp >> 18));
+            bytes[1] = static_cast<unsigned char>(0x80 | ((cp >> 12) & 0x3F));
+            bytes[2] = static_cast<unsigned char>(0x80 | ((cp >> 6) & 0x3F));
+            bytes[3] = static_cast<unsigned char>(0x80 | (cp & 0x3F));
+            return 4;
+        }
+    }
+
+    /**
+     * Split the codepoint range <code>[lo, hi]</code> into UTF-8 byte
+     * sequences, surrogates are left out. The DFA built from the sequences
+     * runs on raw bytes and never decodes the input.
+     * @param lo The first codepoint
+     * @param hi The last codepoint
+     * @return Byte sequences
+     */
+    constexpr utf8_sequences utf8_split(char32_t lo, char32_t hi) {
+        utf8_sequences ret;
+        std::array<std::array<char32_t, 2>, utf8_sequences::capacity> to_split{};
+        std::size_t to_split_size = 0;
+        to_split[to_split_size++] = {lo, hi};
+
+        while (to_split_size) {
+            auto [s, e] = to_split[--to_split_size];
+            bool split = true;
+            while (split && s <= e) {
+                split = false;
+                // leave the surrogates out
+                if (s < 0xE000 && e > 0xD7FF) {
+                    if (e >= 0xE000) {
+                        to_split[to_split_size++] = {0xE000, e};
+                    }
+                    if (s > 0xD7FF) {
+                        break;
+                    }
+                    e = 0xD7FF;
+                }
+                // the ranges of the same encoded length
+                for (char32_t max: {char32_t{0x7F}, char32_t{0x7FF}, char32_t{0xFFFF}}) {
+                    if (s <= max && max < e) {
+                        to_split[to_split_size++] = {max + 1, e};
+                        e = max;
+                        split = true;
+                        break;
+                    }
+                }
+                if (split) {
+                    continue;
+                }
+                // the ranges sharing all but the trailing bytes
+                for (std::size_t i = 1; i < 4 && !split; ++i) {
+                    char32_t m = (char32_t{1} << (6 * i)) - 1;
+                    if ((s & ~m) != (e & ~m)) {
+                        if ((s & m) != 0) {
+                            to_split[to_split_size++] = {(s | m) + 1, e};
+                            e = s | m;
+                            split = true;
+                        } else if ((e & m) != m) {
+                            to_split[to_split_size++] = {e & ~m, e};
+                            e = (e & ~m) - 1;
+                            split = true;
+                        }
+                    }
+                }
+                if (split) {
+                    continue;
+                }
+
+                utf8_sequence &seq = ret.seqs[ret.count++];
+                seq.length = utf8_encode(s, seq.lo);
+                utf8_encode(e, seq.hi);
+            }
+        }
+        return ret;
+    }
+
+    /**
+     * Size of the NFA recognizing the codepoint range <code>[lo, hi]</code>
+     * built by <code>utf8_create_nfa</code>
+     */
+    constexpr std::size_t utf8_nfa_size(char32_t lo, char32_t hi) {
+        auto seqs = utf8_split(lo, hi);
+        std::size_t ret = 2;
+        for (std::size_t i = 0; i < seqs.count; ++i) {
+            ret += seqs.seqs[i].length - 1;
+        }
+        return ret;
+    }
+
+    /**
+     * Name of the codepoint in the Unicode notation, uppercase hex of at
+     * least 4 digits, e.g. <code>U+4E00</code>
+     */
+    inline std::string utf8_codepoint_name(char32_t cp) {
+        std::string digits;
+        do {
+            digits.insert(digits.begin(), "0123456789ABCDEF"[cp & 0xF]);
+            cp >>= 4;
+        } while (cp != 0);
+        if (digits.size() < 4) {
+            digits.insert(digits.begin(), 4 - digits.size(), '0');
+        }
+        return "U+" + digits;
+    }
+
+    /**
+     * Create the NFA recognizing the UTF-8 encoding of the codepoint range
+     * <code>[lo, hi]</code>, status <code>zero_status</code> is the initial
+     * status and the last one is the accepting status.
+     */
+    inline void utf8_create_nfa(nfa &fa, status_type zero_status, char32_t lo, char32_t hi) {
+        auto seqs = utf8_split(lo, hi);
+        status_type acc_status = zero_status + utf8_nfa_size(lo, hi) - 1;
+        status_type next_status = zero_status + 1;
+        for (std::size_t i = 0; i < seqs.count; ++i) {
+            auto &seq = seqs.seqs[i];
+            status_type from = zero_status;
+            for (std::size_t b = 0; b < seq.length; ++b) {
+                status_type to = b + 1 == seq.length ? acc_status : next_status++;
+                for (input_type v = seq.lo[b]; v <= seq.hi[b]; ++v) {
+                    fa.add_trans(from, to, v);
+                }
+                from = to;
+            }
+        }
+    }
+
+}
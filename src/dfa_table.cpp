@@ -0,0 +1,259 @@
+#include "dfa_table.hpp"
+#include "fused_dfa.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+namespace lexer0 {
+
+    namespace {
+        // the dense table up to this size fits in L1 cache, whatever its density
+        constexpr std::size_t dense_budget = 32 * 1024;
+        // below this density the comb layout is used for a larger table
+        constexpr double comb_density = 0.25;
+
+        std::uint32_t row_default_of(const std::vector<std::uint32_t> &row) {
+            std::map<std::uint32_t, std::size_t> count;
+            for (auto t: row) {
+                ++count[t];
+            }
+            return std::max_element(count.begin(), count.end(),
+                                    [](auto &l, auto &r) { return l.second < r.second; })->first;
+        }
+    }
+
+    dfa_table::dfa_table(const fused_dfa &fa) {
+        auto rows = build_rows(fa);
+        std::size_t dense_bytes = rows.size() * class_size * sizeof(std::uint32_t);
+        if (dense_bytes <= dense_budget || density() >= comb_density) {
+            build_dense(rows);
+        } else {
+            build_comb(rows);
+        }
+    }
+
+    dfa_table::dfa_table(const fused_dfa &fa, layout l) {
+        auto rows = build_rows(fa);
+        if (l == layout::dense) {
+            build_dense(rows);
+        } else {
+            build_comb(rows);
+        }
+    }
+
+    std::vector<std::vector<std::uint32_t>> dfa_table::build_rows(const fused_dfa &fa) {
+        const std::size_t size = fa.status_size();
+        ini_status = static_cast<std::uint32_t>(fa.initial_status());
+
+        // the bytes with the same column of targets share a class
+        std::map<std::vector<std::uint32_t>, std::uint8_t> column_class;
+        std::vector<std::vector<std::uint32_t>> class_column;
+        for (std::size_t c = 0; c < 256; ++c) {
+            std::vector<std::uint32_t> column(size, dead);
+            for (status_type s = 0; s < size; ++s) {
+                auto &edges = fa.trans_of(s);
+                if (auto it = edges.find(static_cast<input_type>(c)); it != edges.end()) {
+                    column.at(s) = static_cast<std::uint32_t>(it->second);
+                }
+            }
+            auto [it, inserted] = column_class.emplace(column, class_column.size());
+            if (inserted) {
+                class_column.push_back(column);
+            }
+            byte_class.at(c) = it->second;
+        }
+        class_size = class_column.size();
+
+        std::vector<std::vector<std::uint32_t>> rows(size, std::vector<std::uint32_t>(class_size));
+        for (std::size_t cls = 0; cls < class_size; ++cls) {
+            for (status_type s = 0; s < size; ++s) {
+                rows.at(s).at(cls) = class_column.at(cls).at(s);
+            }
+        }
+
+        accept_reg.resize(size);
+        trap_status.resize(size);
+        non_default_size = 0;
+        for (status_type s = 0; s < size; ++s) {
+            auto reg = fa.accept_of(s);
+            accept_reg.at(s) = reg == fused_dfa::npos ? no_accept : static_cast<std::uint32_t>(reg);
+            trap_status.at(s) = fa.trap_of(s);
+            auto d = row_default_of(rows.at(s));
+            non_default_size += std::count_if(rows.at(s).begin(), rows.at(s).end(),
+                                              [d](std::uint32_t t) { return t != d; });
+        }
+
+        loop_ix.assign(size, no_loop);
+        loop_set.clear();
+        loop_exit.clear();
+        for (status_type s = 0; s < size; ++s) {
+            std::array<std::uint64_t, 4> set{};
+            std::size_t loop_bytes = 0;
+            int exit = -1;
+            for (std::size_t c = 0; c < 256; ++c) {
+                if (rows.at(s).at(byte_class.at(c)) == s) {
+                    set.at(c >> 6) |= std::uint64_t{1} << (c & 63);
+                    ++loop_bytes;
+                } else {
+                    exit = static_cast<int>(c);
+                }
+            }
+            if (loop_bytes == 0) {
+                continue;
+            }
+            loop_ix.at(s) = static_cast<std::uint32_t>(loop_set.size());
+            loop_set.push_back(set);
+            loop_exit.push_back(loop_bytes == 255 ? exit : -1);
+        }
+        return rows;
+    }
+
+    void dfa_table::build_dense(const std::vector<std::vector<std::uint32_t>> &rows) {
+        table_layout = layout::dense;
+        dense_next.clear();
+        dense_next.reserve(rows.size() * class_size);
+        for (auto &row: rows) {
+            dense_next.insert(dense_next.end(), row.begin(), row.end());
+        }
+    }
+
+    void dfa_table::build_comb(const std::vector<std::vector<std::uint32_t>> &rows) {
+        table_layout = layout::comb;
+        row_base.assign(rows.size(), 0);
+        row_default.assign(rows.size(), dead);
+
+        // the non-default transitions of every row
+        std::vector<std::vector<std::tuple<std::uint32_t, std::uint32_t>>> row_entries(rows.size());
+        for (std::size_t s = 0; s < rows.size(); ++s) {
+            row_default.at(s) = row_default_of(rows.at(s));
+            for (std::uint32_t cls = 0; cls < class_size; ++cls) {
+                if (rows.at(s).at(cls) != row_default.at(s)) {
+                    row_entries.at(s).emplace_back(cls, rows.at(s).at(cls));
+                }
+            }
+        }
+
+        // first fit, the fullest rows first
+        std::vector<std::size_t> order(rows.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](std::size_t l, std::size_t r) {
+            return row_entries.at(l).size() > row_entries.at(r).size();
+        });
+
+        std::vector<bool> used;
+        std::size_t first_free = 0, max_base = 0;
+        for (auto s: order) {
+            auto &entries = row_entries.at(s);
+            std::size_t base = entries.empty() ? 0 : first_free - std::min<std::size_t>(
+                    first_free, std::get<0>(entries.front()));
+            while (true) {
+                bool fit = true;
+                for (std::size_t i = 0; fit && i < entries.size(); ++i) {
+                    std::size_t ix = base + std::get<0>(entries[i]);
+                    fit = ix >= used.size() || !used[ix];
+                }
+                if (fit) {
+                    break;
+                }
+                ++base;
+            }
+
+            // the check holds the owner status, so the rows may share a base
+            row_base.at(s) = static_cast<std::uint32_t>(base);
+            max_base = std::max(max_base, base);
+            for (auto [cls, t]: entries) {
+                std::size_t ix = base + cls;
+                if (ix >= used.size()) {
+                    used.resize(ix + 1, false);
+                }
+                used[ix] = true;
+            }
+            while (first_free < used.size() && used[first_free]) {
+                ++first_free;
+            }
+        }
+
+        // every row base plus any class stays in the array
+        comb_next.assign(std::max(used.size(), max_base + class_size), dead);
+        comb_check.assign(comb_next.size(), dead);
+        for (std::size_t s = 0; s < rows.size(); ++s) {
+            for (auto [cls, t]: row_entries.at(s)) {
+                comb_next.at(row_base.at(s) + cls) = t;
+                comb_check.at(row_base.at(s) + cls) = static_cast<std::uint32_t>(s);
+            }
+        }
+    }
+
+    std::tuple<std::size_t, std::size_t> dfa_table::longest_match(std::string_view sv,
+                                                                  std::size_t start_ix) const {
+        std::size_t match_reg = fused_dfa::npos, match_length = 0;
+        std::uint32_t s = ini_status;
+        for (std::size_t curr_ix = start_ix; curr_ix < sv.size(); ++curr_ix) {
+            s = next(s, static_cast<unsigned char>(sv[curr_ix]));
+            if (s == dead) {
+                break;
+            }
+            if (loop_ix[s] != no_loop) {
+                curr_ix = skip_loop(sv, curr_ix + 1, loop_ix[s]) - 1;
+            }
+            if (accept_reg[s] != no_accept) {
+                match_reg = accept_reg[s];
+                match_length = curr_ix - start_ix + 1;
+            }
+            if (trap_status[s]) {
+                break;
+            }
+        }
+        return {match_reg, match_length};
+    }
+
+    std::size_t dfa_table::skip_loop(std::string_view sv, std::size_t from_ix, std::uint32_t l) const {
+        if (loop_exit[l] >= 0) {
+            auto *exit = static_cast<const char *>(
+                    std::memchr(sv.data() + from_ix, loop_exit[l], sv.size() - from_ix));
+            return exit ? static_cast<std::size_t>(exit - sv.data()) : sv.size();
+        }
+        auto &set = loop_set[l];
+        while (from_ix < sv.size()) {
+            auto c = static_cast<unsigned char>(sv[from_ix]);
+            if (!((set[c >> 6] >> (c & 63)) & 1)) {
+                break;
+            }
+            ++from_ix;
+        }
+        return from_ix;
+    }
+
+    dfa_table::layout dfa_table::get_layout() const {
+        return table_layout;
+    }
+
+    std::size_t dfa_table::classes() const {
+        return class_size;
+    }
+
+    std::size_t dfa_table::table_bytes() const {
+        std::size_t ret = sizeof(byte_class);
+        if (table_layout == layout::dense) {
+            ret += dense_next.size() * sizeof(std::uint32_t);
+        } else {
+            ret += (row_base.size() + row_default.size() + comb_next.size() + comb_check.size()) *
+                   sizeof(std::uint32_t);
+        }
+        return ret;
+    }
+
+    double dfa_table::density() const {
+        std::size_t entries = accept_reg.size() * class_size;
+        return entries ? static_cast<double>(non_default_size) / static_cast<double>(entries) : 0;
+    }
+
+    std::string dfa_table::to_string() const {
+        return std::string{table_layout == layout::dense ? "dense" : "comb"} +
+               " table, " + std::to_string(accept_reg.size()) + " statuses, " +
+               std::to_string(class_size) + " classes, " +
+               std::to_string(table_bytes()) + " bytes";
+    }
+
+}
@@ -0,0 +1,321 @@
+#include "fused_dfa.hpp"
+
+#include <algorithm>
+#include <istream>
+#include <numeric>
+#include <ostream>
+#include <stdexcept>
+
+namespace lexer0 {
+
+    fused_dfa::fused_dfa(const std::vector<dfa> &fas) : size{0}, ini_status{0} {
+        for (auto &fa: fas) {
+            registered_input.insert(fa.registered_input.begin(), fa.registered_input.end());
+        }
+
+        /* a component status from which no accepting status is reachable
+            any more is folded into npos, the dead status */
+        auto fold = [&fas](std::size_t fa_ix, status_type s) -> status_type {
+            auto &fa = fas.at(fa_ix);
+            return fa.trap_status.at(s) && !fa.accept_status.at(s) ? npos : s;
+        };
+
+        std::map<std::vector<status_type>, status_type> status_id;
+        std::vector<std::vector<status_type>> status_tuple;
+        std::queue<status_type> to_visit;
+
+        std::vector<status_type> ini_tuple;
+        for (std::size_t fa_ix = 0; fa_ix < fas.size(); ++fa_ix) {
+            ini_tuple.push_back(fold(fa_ix, fas.at(fa_ix).ini_status));
+        }
+        status_id.emplace(ini_tuple, 0);
+        status_tuple.push_back(ini_tuple);
+        to_visit.push(0);
+
+        while (!to_visit.empty()) {
+            status_type from = to_visit.front();
+            to_visit.pop();
+            trans.emplace_back();
+
+            for (input_type v: registered_input) {
+                std::vector<status_type> to_tuple;
+                bool all_dead = true;
+                for (std::size_t fa_ix = 0; fa_ix < fas.size(); ++fa_ix) {
+                    status_type s = status_tuple.at(from).at(fa_ix);
+                    status_type t = npos;
+                    if (s != npos) {
+                        auto &edges = fas.at(fa_ix).trans.at(s);
+                        if (auto it = edges.find(v); it != edges.end()) {
+                            t = fold(fa_ix, it->second);
+                        }
+                    }
+                    all_dead &= t == npos;
+                    to_tuple.push_back(t);
+                }
+                if (all_dead) {
+                    continue;
+                }
+
+                auto [it, inserted] = status_id.emplace(to_tuple, status_tuple.size());
+                if (inserted) {
+                    status_tuple.push_back(to_tuple);
+                    to_visit.push(it->second);
+                }
+                trans.at(from).emplace(v, it->second);
+            }
+        }
+
+        size = status_tuple.size();
+        accept_reg.assign(size, npos);
+        trap_status.assign(size, true);
+        for (status_type s = 0; s < size; ++s) {
+            for (std::size_t fa_ix = 0; fa_ix < fas.size(); ++fa_ix) {
+                status_type cs = status_tuple.at(s).at(fa_ix);
+                if (cs == npos) {
+                    continue;
+                }
+                if (accept_reg.at(s) == npos && fas.at(fa_ix).accept_status.at(cs)) {
+                    accept_reg.at(s) = fa_ix;
+                }
+                if (!fas.at(fa_ix).trap_status.at(cs)) {
+                    trap_status.at(s) = false;
+                }
+            }
+        }
+
+        minimize();
+        table = dfa_table{*this};
+    }
+
+    void fused_dfa::minimize() {
+        // initial partition, by the accepting rule and the trap flag
+        std::vector<std::size_t> cls(size);
+        {
+            std::map<std::tuple<std::size_t, bool>, std::size_t> first_cls;
+            for (status_type s = 0; s < size; ++s) {
+                auto key = std::make_tuple(accept_reg.at(s), static_cast<bool>(trap_status.at(s)));
+                cls.at(s) = first_cls.emplace(key, first_cls.size()).first->second;
+            }
+        }
+
+        // refine until stable
+        std::size_t cls_size = 0;
+        while (true) {
+            std::map<std::vector<std::size_t>, std::size_t> signature_cls;
+            std::vector<std::size_t> next_cls(size);
+            for (status_type s = 0; s < size; ++s) {
+                std::vector<std::size_t> signature{cls.at(s)};
+                for (input_type v: registered_input) {
+                    auto it = trans.at(s).find(v);
+                    signature.push_back(it == trans.at(s).end() ? npos : cls.at(it->second));
+                }
+                next_cls.at(s) = signature_cls.emplace(signature, signature_cls.size()).first->second;
+            }
+            cls.swap(next_cls);
+            if (signature_cls.size() == cls_size) {
+                break;
+            }
+            cls_size = signature_cls.size();
+        }
+
+        if (cls_size == size) {
+            return;
+        }
+
+        // renumber the classes so that the initial status stays 0
+        std::vector<status_type> cls_status(cls_size, npos);
+        status_type next_status = 0;
+        cls_status.at(cls.at(ini_status)) = next_status++;
+        for (status_type s = 0; s < size; ++s) {
+            if (cls_status.at(cls.at(s)) == npos) {
+                cls_status.at(cls.at(s)) = next_status++;
+            }
+        }
+
+        std::vector<std::map<input_type, status_type>> min_trans(cls_size);
+        std::vector<std::size_t> min_accept_reg(cls_size);
+        std::vector<bool> min_trap_status(cls_size);
+        for (status_type s = 0; s < size; ++s) {
+            status_type ms = cls_status.at(cls.at(s));
+            for (auto [v, t]: trans.at(s)) {
+                min_trans.at(ms)[v] = cls_status.at(cls.at(t));
+            }
+            min_accept_reg.at(ms) = accept_reg.at(s);
+            min_trap_status.at(ms) = trap_status.at(s);
+        }
+
+        size = cls_size;
+        ini_status = 0;
+        trans.swap(min_trans);
+        accept_reg.swap(min_accept_reg);
+        trap_status.swap(min_trap_status);
+    }
+
+    size_type fused_dfa::status_size() const {
+        return size;
+    }
+
+    status_type fused_dfa::initial_status() const {
+        return ini_status;
+    }
+
+    const std::set<input_type> &fused_dfa::inputs() const {
+        return registered_input;
+    }
+
+    const std::map<input_type, status_type> &fused_dfa::trans_of(status_type s) const {
+        return trans.at(s);
+    }
+
+    std::size_t fused_dfa::accept_of(status_type s) const {
+        return accept_reg.at(s);
+    }
+
+    bool fused_dfa::trap_of(status_type s) const {
+        return trap_status.at(s);
+    }
+
+    const dfa_table &fused_dfa::get_table() const {
+        return table;
+    }
+
+    std::tuple<std::size_t, std::size_t> fused_dfa::longest_match(std::string_view sv,
+                                                                  std::size_t start_ix) const {
+        return table.longest_match(sv, start_ix);
+    }
+
+    std::vector<std::uint64_t> fused_dfa::profile(std::string_view corpus) const {
+        std::vector<std::uint64_t> visits(size, 0);
+        std::size_t start_ix = 0;
+        while (start_ix < corpus.size()) {
+            std::size_t match_length = 0;
+            std::uint32_t s = static_cast<std::uint32_t>(ini_status);
+            ++visits[s];
+            for (std::size_t curr_ix = start_ix; curr_ix < corpus.size(); ++curr_ix) {
+                s = table.next(s, static_cast<unsigned char>(corpus[curr_ix]));
+                if (s == dfa_table::dead) {
+                    break;
+                }
+                ++visits[s];
+                if (accept_reg[s] != npos) {
+                    match_length = curr_ix - start_ix + 1;
+                }
+                if (trap_status[s]) {
+                    break;
+                }
+            }
+            // go on after the input no rule accepts
+            start_ix += std::max<std::size_t>(match_length, 1);
+        }
+        return visits;
+    }
+
+    std::vector<status_type> fused_dfa::hot_order(const std::vector<std::uint64_t> &visits) const {
+        std::vector<status_type> by_visits(size);
+        std::iota(by_visits.begin(), by_visits.end(), 0);
+        std::stable_sort(by_visits.begin(), by_visits.end(), [&visits](status_type l, status_type r) {
+            return visits.at(l) > visits.at(r);
+        });
+
+        std::vector<status_type> order;
+        std::vector<bool> placed(size, false);
+        auto place_chain = [&](status_type s) {
+            while (s != npos && !placed.at(s)) {
+                placed.at(s) = true;
+                order.push_back(s);
+                // go on with the hottest successor not placed yet
+                status_type hottest = npos;
+                for (auto [v, t]: trans.at(s)) {
+                    if (!placed.at(t) && (hottest == npos || visits.at(t) > visits.at(hottest))) {
+                        hottest = t;
+                    }
+                }
+                s = hottest;
+            }
+        };
+        place_chain(ini_status);
+        for (auto s: by_visits) {
+            place_chain(s);
+        }
+        return order;
+    }
+
+    void fused_dfa::reorder(const std::vector<status_type> &order) {
+        std::vector<status_type> new_status(size, npos);
+        for (status_type i = 0; i < order.size(); ++i) {
+            if (order.at(i) >= size || new_status.at(order.at(i)) != npos) {
+                throw std::invalid_argument("The order is not a permutation of the statuses.");
+            }
+            new_status.at(order.at(i)) = i;
+        }
+        if (order.size() != size) {
+            throw std::invalid_argument("The order is not a permutation of the statuses.");
+        }
+
+        std::vector<std::map<input_type, status_type>> new_trans(size);
+        std::vector<std::size_t> new_accept_reg(size);
+        std::vector<bool> new_trap_status(size);
+        for (status_type s = 0; s < size; ++s) {
+            status_type ns = new_status.at(s);
+            for (auto [v, t]: trans.at(s)) {
+                new_trans.at(ns).emplace(v, new_status.at(t));
+            }
+            new_accept_reg.at(ns) = accept_reg.at(s);
+            new_trap_status.at(ns) = trap_status.at(s);
+        }
+
+        ini_status = new_status.at(ini_status);
+        trans.swap(new_trans);
+        accept_reg.swap(new_accept_reg);
+        trap_status.swap(new_trap_status);
+        table = dfa_table{*this};
+    }
+
+    void fused_dfa::write_order(std::ostream &os, const std::vector<status_type> &order) {
+        os << order.size();
+        for (auto s: order) {
+            os << ' ' << s;
+        }
+        os << '\n';
+    }
+
+    std::vector<status_type> fused_dfa::read_order(std::istream &is) {
+        std::size_t order_size = 0;
+        is >> order_size;
+        // the statuses are numbered by 32 bits in the table
+        if (!is || order_size > dfa_table::dead) {
+            throw std::invalid_argument("Malformed status order.");
+        }
+        // grown as the statuses are read, so a bogus size fails at the end of the stream, not in allocation
+        std::vector<status_type> order;
+        for (std::size_t i = 0; i < order_size; ++i) {
+            status_type s;
+            if (!(is >> s)) {
+                throw std::invalid_argument("Malformed status order.");
+            }
+            order.push_back(s);
+        }
+        return order;
+    }
+
+    std::string fused_dfa::to_string() const {
+        std::string ret;
+        for (status_type s = 0; s < size; ++s) {
+            ret += "status " + std::to_string(s) + ':';
+            for (auto [v, t]: trans.at(s)) {
+                ret += " [" + std::to_string(v) + "]=>" + std::to_string(t);
+            }
+            ret += '\n';
+        }
+        ret += "from: " + std::to_string(ini_status) + '\n';
+        ret += "accept:";
+        for (status_type s = 0; s < size; ++s) {
+            if (accept_reg.at(s) != npos) {
+                ret += ' ' + std::to_string(s) + '(' + std::to_string(accept_reg.at(s)) + ')';
+            }
+        }
+        ret += '\n';
+        return ret;
+    }
+
+}
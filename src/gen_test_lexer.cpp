@@ -0,0 +1,21 @@
+#include "test_lexer.hpp"
+#include "lexer_codegen.hpp"
+
+#include <fstream>
+#include <iostream>
+
+using namespace lexer0;
+
+int main(int argc, char *argv[]) {
+    if (argc != 2) {
+        std::cerr << "usage: " << argv[0] << " <output.cpp>" << std::endl;
+        return 1;
+    }
+
+    test_lexer_type the_lexer;
+    test_skip_lexer_type skip_lexer;
+    std::ofstream out{argv[1]};
+    out << generate_direct_lexer(the_lexer.get_fused(), "test_lexer_direct") << '\n'
+        << generate_direct_lexer(skip_lexer.get_fused(), "test_skip_lexer_direct", test_skip_lexer_type::skip_flags());
+    return out ? 0 : 1;
+}
@@ -0,0 +1,119 @@
+#include "lexer_codegen.hpp"
+
+#include <sstream>
+
+namespace lexer0 {
+
+    std::string generate_direct_lexer(const fused_dfa &fa, const std::string &func_name,
+                                      const std::vector<bool> &skip_regs) {
+        std::ostringstream out;
+
+        out << "// Generated by lexer_codegen, do not edit.\n"
+               "#include <string>\n"
+               "#include <vector>\n"
+               "\n"
+               "#include \"token.hpp\"\n"
+               "\n"
+               "std::vector<lexer0::token> " << func_name << "(const std::string &sv) {\n"
+               "    std::vector<lexer0::token> token_stream;\n"
+               "    const std::size_t sv_size = sv.size();\n"
+               "    std::size_t start_ix = 0, curr_ix = 0, match_reg = 0, match_ix = 0;\n"
+               "    bool reg_match = false;\n"
+               "    int c;\n"
+               "\n"
+               "next_token:\n"
+               "    if (start_ix >= sv_size) {\n"
+               "        return token_stream;\n"
+               "    }\n"
+               "    curr_ix = start_ix;\n"
+               "    reg_match = false;\n"
+               "    goto status_" << fa.initial_status() << "_body;\n";
+
+        // the initial status is labeled only if some transition leads back to it
+        bool initial_targeted = false;
+        for (status_type s = 0; s < fa.status_size(); ++s) {
+            for (auto [v, t]: fa.trans_of(s)) {
+                initial_targeted = initial_targeted || t == fa.initial_status();
+            }
+        }
+
+        for (status_type s = 0; s < fa.status_size(); ++s) {
+            out << '\n';
+            bool labeled = s != fa.initial_status() || initial_targeted;
+            if (labeled) {
+                out << "status_" << s << ":\n";
+            }
+            if (labeled && fa.accept_of(s) != fused_dfa::npos) {
+                out << "    match_reg = " << fa.accept_of(s) << ";\n"
+                       "    match_ix = curr_ix;\n"
+                       "    reg_match = true;\n";
+            }
+            // the initial status is entered without accepting the empty input
+            if (s == fa.initial_status()) {
+                out << "status_" << s << "_body:\n";
+            }
+            if (fa.trap_of(s)) {
+                out << "    goto emit;\n";
+                continue;
+            }
+            out << "    if (curr_ix == sv_size) {\n"
+                   "        goto emit;\n"
+                   "    }\n"
+                   "    c = static_cast<unsigned char>(sv[curr_ix++]);\n"
+                   "    switch (c) {\n";
+
+            // group the inputs by their target status, one branch per target
+            std::map<status_type, std::vector<input_type>> target_inputs;
+            for (auto [v, t]: fa.trans_of(s)) {
+                target_inputs[t].push_back(v);
+            }
+            for (auto &[t, vs]: target_inputs) {
+                out << "       ";
+                for (auto v: vs) {
+                    out << " case " << v << ':';
+                }
+                out << "\n"
+                       "            goto status_" << t << ";\n";
+            }
+            out << "        default:\n"
+                   "            goto emit;\n"
+                   "    }\n";
+        }
+
+        out << "\n"
+               "emit:\n"
+               "    if (!reg_match) {\n"
+               "        return token_stream;\n"
+               "    }\n";
+        // the tokens of the skip rules are matched but not emitted
+        std::vector<std::size_t> skipped;
+        for (std::size_t reg = 0; reg < skip_regs.size(); ++reg) {
+            if (skip_regs.at(reg)) {
+                skipped.push_back(reg);
+            }
+        }
+        if (!skipped.empty()) {
+            out << "    switch (match_reg) {\n"
+                   "       ";
+            for (auto reg: skipped) {
+                out << " case " << reg << ':';
+            }
+            out << "\n"
+                   "            start_ix = match_ix;\n"
+                   "            goto next_token;\n"
+                   "        default:\n"
+                   "            break;\n"
+                   "    }\n";
+        }
+        out << "    token_stream.push_back(lexer0::token{match_reg,\n"
+               "                                         start_ix,\n"
+               "                                         match_ix - start_ix,\n"
+               "                                         sv.substr(start_ix, match_ix - start_ix)});\n"
+               "    start_ix = match_ix;\n"
+               "    goto next_token;\n"
+               "}\n";
+
+        return out.str();
+    }
+
+}
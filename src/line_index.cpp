@@ -0,0 +1,72 @@
+#include "line_index.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace lexer0 {
+
+    namespace {
+        // the queries scan ahead to this granularity, so that the blocks of 16 bytes stay whole
+        constexpr std::size_t scan_stride = 256;
+    }
+
+    line_index::line_index(std::string_view sv) {
+        append(sv);
+    }
+
+    void line_index::append(std::string_view next_chunk) {
+        scan_to(chunk.size());
+        chunk_offset += chunk.size();
+        chunk = next_chunk;
+        scanned = 0;
+    }
+
+    void line_index::scan_to(std::size_t chunk_ix) {
+        const char *data = chunk.data();
+        std::size_t ix = scanned;
+#ifdef __SSE2__
+        // 16 bytes compared at once, a set bit of the mask for every newline
+        const __m128i newline = _mm_set1_epi8('\n');
+        for (; ix + 16 <= chunk_ix; ix += 16) {
+            auto block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + ix));
+            auto mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, newline)));
+            while (mask) {
+                line_start.push_back(chunk_offset + ix + static_cast<std::size_t>(__builtin_ctz(mask)) + 1);
+                mask &= mask - 1;
+            }
+        }
+#endif
+        while (ix < chunk_ix) {
+            auto *found = static_cast<const char *>(std::memchr(data + ix, '\n', chunk_ix - ix));
+            if (!found) {
+                break;
+            }
+            ix = static_cast<std::size_t>(found - data) + 1;
+            line_start.push_back(chunk_offset + ix);
+        }
+        scanned = chunk_ix;
+    }
+
+    std::tuple<std::size_t, std::size_t> line_index::position(std::size_t offset) {
+        if (offset > size()) {
+            throw std::out_of_range{"offset out of the input"};
+        }
+        // the newlines before the offset decide its line
+        if (offset > chunk_offset + scanned) {
+            scan_to(std::min(chunk.size(), (offset - chunk_offset + scan_stride - 1) / scan_stride * scan_stride));
+        }
+        auto it = std::upper_bound(line_start.begin(), line_start.end(), offset);
+        auto line = static_cast<std::size_t>(it - line_start.begin()) - 1;
+        return {line, offset - line_start.at(line)};
+    }
+
+    std::size_t line_index::size() const {
+        return chunk_offset + chunk.size();
+    }
+
+}
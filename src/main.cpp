@@ -1,8 +1,34 @@
 #include "t_lexer.hpp"
 
 void test_lexer();
+void test_lazy_lexer();
+void test_interned_lexer();
+void test_skip_lexer();
+void test_utf8_lexer();
+void test_number_lexer();
+void test_line_index();
+void bench_lexer();
+void bench_batch_lexer();
+void bench_dfa_table();
+void bench_skip_lexer();
+void bench_hot_layout();
+void bench_number_lexer();
+void bench_line_index();
 
 int main() {
     test_lexer();
+    test_lazy_lexer();
+    test_interned_lexer();
+    test_skip_lexer();
+    test_utf8_lexer();
+    test_number_lexer();
+    test_line_index();
+    bench_lexer();
+    bench_batch_lexer();
+    bench_dfa_table();
+    bench_skip_lexer();
+    bench_hot_layout();
+    bench_number_lexer();
+    bench_line_index();
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,122 @@
+#include "number_decoder.hpp"
+
+#include <charconv>
+#include <cstdlib>
+#include <string>
+#include <type_traits>
+
+namespace lexer0 {
+
+    namespace {
+        // the powers of ten exact in double
+        constexpr double exact_pow10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                          1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+        // the powers of ten exact in float
+        constexpr float exact_pow10_f[] = {1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f};
+
+        template<typename T>
+        bool decode_slow(std::string_view sv, double &value) {
+            T v{};
+            auto [ptr, ec] = std::from_chars(sv.data(), sv.data() + sv.size(), v);
+            if (ec == std::errc::result_out_of_range) {
+                // from_chars leaves the value alone, strtod gives the infinity or the zero
+                std::string s{sv};
+                value = std::is_same_v<T, float> ? std::strtof(s.c_str(), nullptr)
+                                                 : std::strtod(s.c_str(), nullptr);
+                return true;
+            }
+            value = v;
+            return ec == std::errc{} && ptr == sv.data() + sv.size();
+        }
+    }
+
+    bool decode_integer(std::string_view sv, std::uint64_t &value) {
+        unsigned base = 10;
+        std::size_t ix = 0;
+        if (sv.size() > 2 && sv[0] == '0' && (sv[1] == 'x' || sv[1] == 'X')) {
+            base = 16;
+            ix = 2;
+        } else if (sv.size() > 1 && sv[0] == '0') {
+            base = 8;
+            ix = 1;
+        }
+        auto [ptr, ec] = std::from_chars(sv.data() + ix, sv.data() + sv.size(), value, static_cast<int>(base));
+        return ec == std::errc{} && ptr == sv.data() + sv.size();
+    }
+
+    bool decode_float(std::string_view sv, double &value) {
+        bool single = !sv.empty() && (sv.back() == 'f' || sv.back() == 'F');
+        if (single) {
+            sv.remove_suffix(1);
+        }
+
+        // the significant digits, and the power of ten they are scaled by
+        std::uint64_t mantissa = 0;
+        int digit_count = 0, exp10 = 0;
+        bool truncated = false, any_digit = false;
+        std::size_t ix = 0;
+        auto take_digits = [&](bool fraction) {
+            for (; ix < sv.size() && sv[ix] >= '0' && sv[ix] <= '9'; ++ix) {
+                any_digit = true;
+                if (digit_count == 0 && sv[ix] == '0') {
+                    exp10 -= fraction;
+                    continue;
+                }
+                if (digit_count < 19) {
+                    mantissa = mantissa * 10 + static_cast<unsigned>(sv[ix] - '0');
+                    ++digit_count;
+                    exp10 -= fraction;
+                } else {
+                    truncated |= sv[ix] != '0';
+                    exp10 += !fraction;
+                }
+            }
+        };
+        take_digits(false);
+        if (ix < sv.size() && sv[ix] == '.') {
+            ++ix;
+            take_digits(true);
+        }
+        // a lone dot, as in ".", ".f" or ".e5", is no number
+        if (!any_digit) {
+            return false;
+        }
+        if (ix < sv.size() && (sv[ix] == 'e' || sv[ix] == 'E')) {
+            ++ix;
+            bool negative = ix < sv.size() && sv[ix] == '-';
+            ix += negative;
+            int e = 0;
+            std::size_t first_ix = ix;
+            for (; ix < sv.size() && sv[ix] >= '0' && sv[ix] <= '9'; ++ix) {
+                e = e < 100000 ? e * 10 + (sv[ix] - '0') : e;
+            }
+            if (ix == first_ix) {
+                return false;
+            }
+            exp10 += negative ? -e : e;
+        }
+        if (ix != sv.size()) {
+            return false;
+        }
+
+        if (mantissa == 0 && !truncated) {
+            value = 0;
+            return true;
+        }
+        if (!truncated) {
+            if (single) {
+                if (mantissa <= (std::uint64_t{1} << 24) && exp10 >= -10 && exp10 <= 10) {
+                    auto m = static_cast<float>(mantissa);
+                    value = exp10 < 0 ? m / exact_pow10_f[-exp10] : m * exact_pow10_f[exp10];
+                    return true;
+                }
+            } else if (mantissa <= (std::uint64_t{1} << 53) && exp10 >= -22 && exp10 <= 22) {
+                auto m = static_cast<double>(mantissa);
+                value = exp10 < 0 ? m / exact_pow10[-exp10] : m * exact_pow10[exp10];
+                return true;
+            }
+        }
+        return single ? decode_slow<float>(sv, value) : decode_slow<double>(sv, value);
+    }
+
+}
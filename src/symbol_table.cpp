@@ -0,0 +1,151 @@
+#include "symbol_table.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+namespace lexer0 {
+
+    symbol_table::symbol_table(std::size_t capacity) {
+        slots.assign(std::bit_ceil(std::max<std::size_t>(capacity * 2, 16)), slot{0, no_symbol});
+        names.reserve(capacity);
+    }
+
+    std::uint32_t symbol_table::hash_of(std::string_view name) {
+        std::uint32_t hash = 2166136261u;
+        for (char c: name) {
+            hash = (hash ^ static_cast<unsigned char>(c)) * 16777619u;
+        }
+        return hash;
+    }
+
+    void symbol_table::grow() {
+        std::vector<slot> grown(slots.size() * 2, slot{0, no_symbol});
+        std::size_t mask = grown.size() - 1;
+        for (auto &s: slots) {
+            if (s.id == no_symbol) {
+                continue;
+            }
+            std::size_t ix = s.hash & mask;
+            while (grown[ix].id != no_symbol) {
+                ix = (ix + 1) & mask;
+            }
+            grown[ix] = s;
+        }
+        slots.swap(grown);
+    }
+
+    std::string_view symbol_table::store(std::string_view name) {
+        // no block is allocated yet when the first name is empty
+        if (name.empty()) {
+            return {};
+        }
+        if (name.size() > block_size / 4) {
+            // a long name takes a block of its own
+            blocks.push_back(std::make_unique<char[]>(name.size()));
+            std::memcpy(blocks.back().get(), name.data(), name.size());
+            return {blocks.back().get(), name.size()};
+        }
+        if (block_used + name.size() > block_size) {
+            blocks.push_back(std::make_unique<char[]>(block_size));
+            curr_block = blocks.back().get();
+            block_used = 0;
+        }
+        char *dest = curr_block + block_used;
+        std::memcpy(dest, name.data(), name.size());
+        block_used += name.size();
+        return {dest, name.size()};
+    }
+
+    symbol_type symbol_table::intern(std::string_view name) {
+        return intern(name, hash_of(name));
+    }
+
+    symbol_type symbol_table::intern(std::string_view name, std::uint32_t hash) {
+        std::size_t mask = slots.size() - 1;
+        std::size_t ix = hash & mask;
+        while (slots[ix].id != no_symbol) {
+            if (slots[ix].hash == hash && names[slots[ix].id] == name) {
+                return slots[ix].id;
+            }
+            ix = (ix + 1) & mask;
+        }
+
+        auto id = static_cast<symbol_type>(names.size());
+        names.push_back(store(name));
+        slots[ix] = slot{hash, id};
+        if (names.size() * 2 > slots.size()) {
+            grow();
+        }
+        return id;
+    }
+
+    symbol_type symbol_table::find(std::string_view name) const {
+        std::uint32_t hash = hash_of(name);
+        std::size_t mask = slots.size() - 1;
+        for (std::size_t ix = hash & mask; slots[ix].id != no_symbol; ix = (ix + 1) & mask) {
+            if (slots[ix].hash == hash && names[slots[ix].id] == name) {
+                return slots[ix].id;
+            }
+        }
+        return no_symbol;
+    }
+
+    std::string_view symbol_table::name_of(symbol_type id) const {
+        return names.at(id);
+    }
+
+    std::size_t symbol_table::size() const {
+        return names.size();
+    }
+
+    concurrent_symbol_table::concurrent_symbol_table() {
+        for (auto &chunk: names) {
+            chunk.store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    concurrent_symbol_table::~concurrent_symbol_table() {
+        for (auto &chunk: names) {
+            delete[] chunk.load(std::memory_order_relaxed);
+        }
+    }
+
+    symbol_type concurrent_symbol_table::intern(std::string_view name) {
+        std::uint32_t hash = symbol_table::hash_of(name);
+        auto &sh = shards[hash >> (32 - shard_bits)];
+        std::lock_guard lock{sh.mutex};
+
+        symbol_type local_id = sh.table.intern(name, hash);
+        if (local_id < sh.global_id.size()) {
+            return sh.global_id[local_id];
+        }
+
+        symbol_type id = next_id.fetch_add(1, std::memory_order_relaxed);
+        std::uint64_t pos = std::uint64_t{id} + 1;
+        std::size_t chunk_ix = std::bit_width(pos) - 1;
+        std::string_view *chunk = names[chunk_ix].load(std::memory_order_acquire);
+        if (chunk == nullptr) {
+            auto *allocated = new std::string_view[std::size_t{1} << chunk_ix];
+            if (names[chunk_ix].compare_exchange_strong(chunk, allocated, std::memory_order_acq_rel)) {
+                chunk = allocated;
+            } else {
+                delete[] allocated;
+            }
+        }
+        chunk[pos - (std::uint64_t{1} << chunk_ix)] = sh.table.name_of(local_id);
+        sh.global_id.push_back(id);
+        return id;
+    }
+
+    std::string_view concurrent_symbol_table::name_of(symbol_type id) const {
+        std::uint64_t pos = std::uint64_t{id} + 1;
+        std::size_t chunk_ix = std::bit_width(pos) - 1;
+        return names[chunk_ix].load(std::memory_order_acquire)[pos - (std::uint64_t{1} << chunk_ix)];
+    }
+
+    std::size_t concurrent_symbol_table::size() const {
+        return next_id.load(std::memory_order_relaxed);
+    }
+
+}
@@ -0,0 +1,236 @@
+#include "test_lexer.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <sstream>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace lexer0;
+
+namespace {
+
+    // hardware cache miss counter of this thread, unavailable without perf events
+    class cache_miss_counter {
+    private:
+        int fd{-1};
+
+    public:
+        cache_miss_counter() {
+#ifdef __linux__
+            perf_event_attr attr{};
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.size = sizeof(attr);
+            attr.config = PERF_COUNT_HW_CACHE_MISSES;
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+        }
+
+        ~cache_miss_counter() {
+#ifdef __linux__
+            if (fd >= 0) {
+                close(fd);
+            }
+#endif
+        }
+
+        cache_miss_counter(const cache_miss_counter &) = delete;
+
+        cache_miss_counter &operator=(const cache_miss_counter &) = delete;
+
+        void start() {
+#ifdef __linux__
+            if (fd >= 0) {
+                ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+#endif
+        }
+
+        std::optional<std::uint64_t> stop() {
+#ifdef __linux__
+            std::uint64_t count = 0;
+            if (fd >= 0) {
+                ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+                if (read(fd, &count, sizeof(count)) == sizeof(count)) {
+                    return count;
+                }
+            }
+#endif
+            return std::nullopt;
+        }
+    };
+
+    // ns/byte and cache misses of lexing the input with the table
+    std::tuple<double, std::optional<std::uint64_t>> lex_cost(const dfa_table &table, const std::string &input) {
+        cache_miss_counter misses;
+        std::size_t start_ix = 0;
+        auto begin = std::chrono::steady_clock::now();
+        misses.start();
+        while (start_ix < input.size()) {
+            auto [reg, length] = table.longest_match(input, start_ix);
+            start_ix += reg == fused_dfa::npos ? 1 : length;
+        }
+        auto miss_count = misses.stop();
+        auto end = std::chrono::steady_clock::now();
+        double ns = std::chrono::duration<double, std::nano>(end - begin).count();
+        return {ns / static_cast<double>(input.size()), miss_count};
+    }
+
+}
+
+std::tuple<fused_dfa, std::string> keyword_grammar(std::size_t keyword_size, std::size_t input_size) {
+    std::mt19937 rng{20261019};
+    std::uniform_int_distribution<int> letter{'a', 'z'}, length{4, 12};
+
+    std::vector<std::string> keywords;
+    for (std::size_t i = 0; i < keyword_size; ++i) {
+        std::string word;
+        for (int l = length(rng); l > 0; --l) {
+            word += static_cast<char>(letter(rng));
+        }
+        keywords.push_back(word);
+    }
+
+    // trie of the keywords, the transitions go first so that add_accept sees them all
+    std::vector<std::map<input_type, status_type>> trie(1);
+    std::vector<status_type> accepts;
+    for (auto &word: keywords) {
+        status_type s = 0;
+        for (char c: word) {
+            auto [it, inserted] = trie.at(s).emplace(static_cast<unsigned char>(c), trie.size());
+            if (inserted) {
+                trie.emplace_back();
+            }
+            s = it->second;
+        }
+        accepts.push_back(s);
+    }
+    dfa keyword_dfa{trie.size()};
+    for (status_type s = 0; s < trie.size(); ++s) {
+        for (auto [v, t]: trie.at(s)) {
+            keyword_dfa.add_trans(s, t, v);
+        }
+    }
+    for (auto s: accepts) {
+        keyword_dfa.add_accept(s);
+    }
+    std::vector<dfa> fas{keyword_dfa, t_get_nfa<t_blank_reg>().get_dfa().get_optimize()};
+
+    // keywords drawn by a skewed distribution, as identifiers in the source code are
+    std::string input;
+    std::geometric_distribution<std::size_t> pick{0.01};
+    while (input.size() < input_size) {
+        input += keywords.at(pick(rng) % keywords.size());
+        input += ' ';
+    }
+    return {fused_dfa{fas}, input};
+}
+
+void bench_dfa_table() {
+    auto [fa, input] = keyword_grammar(1400, 1 << 18);
+
+    auto lex_with = [&input](auto &&longest_match) {
+        std::size_t token_count = 0, start_ix = 0;
+        auto begin = std::chrono::steady_clock::now();
+        while (start_ix < input.size()) {
+            auto [reg, length] = longest_match(input, start_ix);
+            if (reg == fused_dfa::npos) {
+                break;
+            }
+            start_ix += length;
+            ++token_count;
+        }
+        auto end = std::chrono::steady_clock::now();
+        double ns = std::chrono::duration<double, std::nano>(end - begin).count();
+        return std::make_tuple(ns / static_cast<double>(input.size()), token_count);
+    };
+
+    // std::map per status, the layout of dfa::trans
+    std::size_t map_bytes = 0;
+    for (status_type s = 0; s < fa.status_size(); ++s) {
+        // node of a red-black tree, 4 pointer-sized fields besides the entry
+        map_bytes += sizeof(std::map<input_type, status_type>) +
+                     fa.trans_of(s).size() * (4 * sizeof(void *) + sizeof(std::pair<input_type, status_type>));
+    }
+    auto [map_ns, map_tokens] = lex_with([&fa](std::string_view sv, std::size_t start_ix) {
+        std::size_t match_reg = fused_dfa::npos, match_length = 0;
+        status_type s = fa.initial_status();
+        for (std::size_t curr_ix = start_ix; curr_ix < sv.size(); ++curr_ix) {
+            auto &edges = fa.trans_of(s);
+            auto it = edges.find(static_cast<unsigned char>(sv[curr_ix]));
+            if (it == edges.end()) {
+                break;
+            }
+            s = it->second;
+            if (fa.accept_of(s) != fused_dfa::npos) {
+                match_reg = fa.accept_of(s);
+                match_length = curr_ix - start_ix + 1;
+            }
+            if (fa.trap_of(s)) {
+                break;
+            }
+        }
+        return std::make_tuple(match_reg, match_length);
+    });
+
+    std::cout << fa.status_size() << " statuses, " << fa.get_table().classes() << " classes, density "
+              << fa.get_table().density() << ", chosen layout: "
+              << (fa.get_table().get_layout() == dfa_table::layout::dense ? "dense" : "comb") << std::endl;
+    std::cout << "map: " << map_bytes << " bytes, " << map_ns << " ns/byte, "
+              << map_tokens << " tokens" << std::endl;
+    for (auto l: {dfa_table::layout::dense, dfa_table::layout::comb}) {
+        dfa_table table{fa, l};
+        auto [ns, tokens] = lex_with([&table](std::string_view sv, std::size_t start_ix) {
+            return table.longest_match(sv, start_ix);
+        });
+        std::cout << table.to_string() << ", " << ns << " ns/byte, " << tokens << " tokens" << std::endl;
+    }
+}
+
+void bench_hot_layout() {
+    auto report = [](const std::string &name, fused_dfa fa, const std::string &input) {
+        // train on the first half, measure on the whole input
+        auto order = fa.hot_order(fa.profile(std::string_view{input}.substr(0, input.size() / 2)));
+
+        // the layout goes through its saved form, as it is shipped with the lexer
+        std::stringstream saved;
+        fused_dfa::write_order(saved, order);
+        fused_dfa hot_fa = fa;
+        hot_fa.reorder(fused_dfa::read_order(saved));
+
+        std::cout << name << ", " << fa.status_size() << " statuses" << std::endl;
+        for (auto l: {dfa_table::layout::dense, dfa_table::layout::comb}) {
+            for (auto *f: {&fa, &hot_fa}) {
+                auto [ns, misses] = lex_cost(dfa_table{*f, l}, input);
+                std::cout << (l == dfa_table::layout::dense ? "  dense" : "  comb")
+                          << (f == &fa ? ", construction order: " : ", hot order: ")
+                          << ns << " ns/byte, cache misses: "
+                          << (misses ? std::to_string(*misses) : std::string{"n/a"}) << std::endl;
+            }
+        }
+    };
+
+    test_lexer_type the_lexer;
+    std::string test_input;
+    std::mt19937 rng{20261019};
+    const std::string words[] = {"x1", "var2", "koo", "3.25e-4f", "15.f", "+", "*", "(", ")", " ", ","};
+    std::uniform_int_distribution<std::size_t> pick{0, std::size(words) - 1};
+    while (test_input.size() < (1 << 18)) {
+        test_input += words[pick(rng)];
+    }
+    report("t_c_identifier_reg/t_float_reg rules", the_lexer.get_fused(), test_input);
+
+    auto [keyword_fa, keyword_input] = keyword_grammar(1400, 1 << 18);
+    report("keyword grammar", keyword_fa, keyword_input);
+}
@@ -1,25 +1,18 @@
-#include "t_lexer.hpp"
+#include "test_lexer.hpp"
+#include "line_index.hpp"
+#include "reg_expr.hpp"
+#include "symbol_table.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
 #include <iostream>
+#include <numeric>
+#include <random>
 
 using namespace lexer0;
 
-void test_lexer() {
-    t_lexer<
-            t_terminate_expr<';'>,
-            t_terminate_expr<':'>,
-            t_terminate_expr<','>,
-            t_terminate_expr<'='>,
-            t_terminate_expr<'('>,
-            t_terminate_expr<')'>,
-            t_terminate_expr<'+'>,
-            t_terminate_expr<'-'>,
-            t_terminate_expr<'*'>,
-            t_terminate_expr<'/'>,
-            t_c_identifier_reg,
-            t_float_reg,
-            t_blank_reg
-    > the_lexer;
+namespace {
 
     const std::string test_str[] = {";func(x1,x2)=x1+x2*x1+x2",
                                     ":f(1,g(223+koo(var1))*5.e3f)+52",
@@ -29,12 +22,457 @@ void test_lexer() {
                                     "var1+var2-var3*(var4/var5-45.23)",
                                     "-var"};
 
+    using token_tuple = std::tuple<std::size_t, std::size_t, std::size_t, std::string>;
+
+    bool same_tokens(const std::vector<token> &lhs, const std::vector<token> &rhs) {
+        return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+                          [](const token &l, const token &r) {
+                              return static_cast<token_tuple>(l) == static_cast<token_tuple>(r);
+                          });
+    }
+
+    // tokens of input sv_ix in the batch are the same as tokens
+    bool same_tokens(const token_batch &batch, std::size_t sv_ix, const std::vector<token> &tokens) {
+        std::size_t first = batch.input_start.at(sv_ix), last = batch.input_start.at(sv_ix + 1);
+        if (last - first != tokens.size()) {
+            return false;
+        }
+        for (std::size_t i = 0; i < tokens.size(); ++i) {
+            auto &t = tokens.at(i);
+            if (batch.token_id.at(first + i) != t.token_id ||
+                batch.token_start.at(first + i) != t.token_start ||
+                batch.token_length.at(first + i) != t.token_length) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // integers go before floats, as t_float_reg matches the decimal integers too
+    using number_lexer_type = t_lexer<
+            t_terminate_expr<','>,
+            t_integer_reg,
+            t_float_reg,
+            t_skip<t_blank_reg>
+    >;
+
+    // (line, column) of the offset by counting the newlines before it, as done before the line index
+    std::tuple<std::size_t, std::size_t> rescan_position(std::string_view sv, std::size_t offset) {
+        auto line = static_cast<std::size_t>(std::count(sv.begin(), sv.begin() + offset, '\n'));
+        auto last_newline = sv.substr(0, offset).rfind('\n');
+        return {line, last_newline == std::string_view::npos ? offset : offset - last_newline - 1};
+    }
+
+    // test_str one per line, repeated up to the size
+    std::string multi_line_input(std::size_t size) {
+        std::string input;
+        while (input.size() < size) {
+            for (auto &str: test_str) {
+                input += str;
+                input += '\n';
+            }
+        }
+        return input;
+    }
+
+    template<typename F>
+    double ns_per_byte(F &&f, const std::string &input, std::size_t rounds) {
+        auto begin = std::chrono::steady_clock::now();
+        for (std::size_t r = 0; r < rounds; ++r) {
+            f(input);
+        }
+        auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::nano>(end - begin).count() /
+               static_cast<double>(input.size() * rounds);
+    }
+
+}
+
+void test_lexer() {
+    test_lexer_type the_lexer;
+    test_skip_lexer_type skip_lexer;
+
     for (auto &str: test_str) {
         std::cout << str << std::endl;
         auto ts = the_lexer.lexer(str);
         for (auto &t: ts) {
             std::cout << t.to_string() << std::endl;
         }
+        if (!same_tokens(ts, test_lexer_direct(str))) {
+            std::cout << "direct-coded lexer mismatch" << std::endl;
+        }
+        if (!same_tokens(skip_lexer.lexer(str), test_skip_lexer_direct(str))) {
+            std::cout << "direct-coded skip lexer mismatch" << std::endl;
+        }
         std::cout << std::endl;
     }
-}
\ No newline at end of file
+}
+
+void test_lazy_lexer() {
+    test_lexer_type the_lexer;
+
+    bool same = true;
+    for (auto &str: test_str) {
+        std::vector<token> ts;
+        for (auto &t: the_lexer.lexer_lazy(str)) {
+            ts.push_back(t);
+        }
+        same &= same_tokens(ts, the_lexer.lexer(str));
+    }
+    std::cout << "lazy lexer, same tokens: " << std::boolalpha << same << std::endl;
+
+    // stop after the first tokens, the rest of the input is never lexed
+    std::string long_str;
+    for (std::size_t i = 0; i < (1 << 16); ++i) {
+        long_str += "x1+";
+    }
+    std::size_t token_count = 0;
+    for (auto &t: the_lexer.lexer_lazy(long_str)) {
+        std::cout << t.to_string() << std::endl;
+        if (++token_count == 4) {
+            break;
+        }
+    }
+    std::cout << std::endl;
+}
+
+void test_interned_lexer() {
+    test_lexer_type the_lexer;
+    const std::vector<std::size_t> interned_ids{test_lexer_type::index_of<t_c_identifier_reg>()};
+
+    symbol_table symbols;
+    std::cout << test_str[0] << std::endl;
+    for (auto &t: the_lexer.lexer(test_str[0], symbols, interned_ids)) {
+        if (t.token_symbol != no_symbol) {
+            std::cout << symbols.name_of(t.token_symbol) << " -> " << t.token_symbol << std::endl;
+        }
+    }
+
+    // every thread interns the same identifiers, the ids must agree and stay dense
+    concurrent_symbol_table shared_symbols;
+    std::vector<std::vector<token>> thread_tokens(4);
+    {
+        std::vector<std::jthread> workers;
+        for (auto &ts: thread_tokens) {
+            workers.emplace_back([&]() {
+                for (auto &str: test_str) {
+                    auto str_ts = the_lexer.lexer(str, shared_symbols, interned_ids);
+                    ts.insert(ts.end(), str_ts.begin(), str_ts.end());
+                }
+            });
+        }
+    }
+    // the interned tokens carry no string, their names come from the plain lexer
+    std::vector<token> plain_tokens;
+    for (auto &str: test_str) {
+        auto str_ts = the_lexer.lexer(str);
+        plain_tokens.insert(plain_tokens.end(), str_ts.begin(), str_ts.end());
+    }
+    bool consistent = true;
+    for (auto &ts: thread_tokens) {
+        consistent &= ts.size() == plain_tokens.size();
+        for (std::size_t i = 0; consistent && i < ts.size(); ++i) {
+            auto &t = ts.at(i);
+            consistent &= t.token_symbol == thread_tokens.front().at(i).token_symbol;
+            if (t.token_symbol != no_symbol) {
+                consistent &= t.token_symbol < shared_symbols.size() && t.token_string.empty() &&
+                              shared_symbols.name_of(t.token_symbol) == plain_tokens.at(i).token_string;
+            }
+        }
+    }
+    std::cout << "concurrent interning: " << shared_symbols.size() << " symbols, consistent: "
+              << std::boolalpha << consistent << std::endl << std::endl;
+}
+
+namespace {
+
+    template<template<typename> typename Skip>
+    using skip_lexer_type = t_lexer<
+            t_terminate_expr<'='>,
+            t_terminate_expr<';'>,
+            t_terminate_expr<'+'>,
+            t_terminate_expr<'*'>,
+            t_terminate_expr<'/'>,
+            t_c_identifier_reg,
+            t_float_reg,
+            Skip<t_line_comment_reg>,
+            Skip<t_blank_reg>
+    >;
+
+    template<typename Regex>
+    using no_skip = Regex;
+
+}
+
+void test_skip_lexer() {
+    skip_lexer_type<t_skip> the_lexer;
+    const std::string str = "x = a / b; // ratio of a and b\n    y = x * 2.5;  // scaled\n";
+    const std::vector<std::size_t> identifier_ids{the_lexer.index_of<t_c_identifier_reg>()};
+
+    std::cout << str;
+    auto ts = the_lexer.lexer(str);
+    for (auto &t: ts) {
+        std::cout << t.to_string() << std::endl;
+    }
+    std::vector<token> lazy_ts;
+    for (auto &t: the_lexer.lexer_lazy(str)) {
+        lazy_ts.push_back(t);
+    }
+    std::cout << "skipped in every lexer: " << std::boolalpha << same_tokens(ts, lazy_ts) << std::endl;
+    for (auto &t: the_lexer.lexer_filtered(str, identifier_ids)) {
+        std::cout << t.to_string() << ' ';
+    }
+    std::cout << std::endl << std::endl;
+}
+
+void bench_skip_lexer() {
+    skip_lexer_type<t_skip> skip_lexer;
+    skip_lexer_type<no_skip> full_lexer;
+
+    // mostly comments and indentation, as the inputs of the search workloads are
+    std::string input;
+    while (input.size() < (1 << 18)) {
+        input += "        // the ratio of the total weight to the number of samples\n"
+                 "        ratio = total / count;\n";
+    }
+
+    const std::vector<std::size_t> identifier_ids{skip_lexer.index_of<t_c_identifier_reg>()};
+    std::vector<std::size_t> all_ids(9);
+    std::iota(all_ids.begin(), all_ids.end(), 0);
+
+    std::size_t full_size = 0, filtered_size = 0;
+    double full_ns = ns_per_byte([&](const std::string &sv) {
+        full_size = full_lexer.lexer_filtered(sv, all_ids).size();
+    }, input, 1);
+    double filtered_ns = ns_per_byte([&](const std::string &sv) {
+        filtered_size = skip_lexer.lexer_filtered(sv, identifier_ids).size();
+    }, input, 1);
+    std::cout << "all tokens: " << full_ns << " ns/byte, " << full_size << " tokens" << std::endl;
+    std::cout << "identifiers only: " << filtered_ns << " ns/byte, " << filtered_size << " tokens" << std::endl;
+}
+
+void test_utf8_lexer() {
+    t_lexer<
+            t_terminate_expr<'='>,
+            t_terminate_expr<'+'>,
+            t_terminate_expr<'*'>,
+            t_utf8_identifier_reg,
+            t_float_reg,
+            t_blank_reg
+    > the_lexer;
+
+    const std::string utf8_str[] = {"größe = π * 半径 * 半径",
+                                    "変数1+переменная*2.5"};
+
+    for (auto &str: utf8_str) {
+        std::cout << str << std::endl;
+        for (auto &t: the_lexer.lexer(str)) {
+            std::cout << t.to_string() << std::endl;
+        }
+        std::cout << std::endl;
+    }
+
+    reg_expr *cjk = new utf8_range_expr{0x4E00, 0x9FFF};
+    auto fa = reg_expr::get_nfa(cjk).get_dfa().get_optimize();
+    delete cjk;
+    bool acc = false;
+    for (char c: std::string{"半"}) {
+        acc = std::get<0>(fa.trans_on(static_cast<unsigned char>(c)));
+    }
+    std::cout << "utf8_range_expr accepts U+534A: " << std::boolalpha << acc << std::endl << std::endl;
+}
+
+void bench_lexer() {
+    test_lexer_type the_lexer;
+
+    std::string input;
+    while (input.size() < (1 << 16)) {
+        for (auto &str: test_str) {
+            input += str;
+            input += ' ';
+        }
+    }
+
+    const std::size_t rounds = 8;
+    std::cout << "interpreted lexer: "
+              << ns_per_byte([&](const std::string &sv) { return the_lexer.lexer(sv); }, input, rounds)
+              << " ns/byte" << std::endl;
+    std::cout << "direct-coded lexer: "
+              << ns_per_byte(test_lexer_direct, input, rounds)
+              << " ns/byte" << std::endl;
+    std::cout << "same tokens: " << std::boolalpha
+              << same_tokens(the_lexer.lexer(input), test_lexer_direct(input)) << std::endl;
+}
+
+void bench_batch_lexer() {
+    test_lexer_type the_lexer;
+
+    std::vector<std::string> inputs;
+    std::size_t input_bytes = 0;
+    for (std::size_t i = 0; i < (1 << 11); ++i) {
+        for (auto &str: test_str) {
+            inputs.push_back(str);
+            input_bytes += str.size();
+        }
+    }
+    // a few long inputs, to skew the work of the chunks
+    for (std::size_t i = 0; i < 4; ++i) {
+        inputs.push_back(std::string(1 << 14, 'x'));
+        input_bytes += inputs.back().size();
+    }
+
+    auto elapsed_ns = [](auto &&f) {
+        auto begin = std::chrono::steady_clock::now();
+        f();
+        auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::nano>(end - begin).count();
+    };
+
+    std::vector<std::vector<token>> per_call(inputs.size());
+    double per_call_ns = elapsed_ns([&]() {
+        for (std::size_t i = 0; i < inputs.size(); ++i) {
+            per_call.at(i) = the_lexer.lexer(inputs.at(i));
+        }
+    });
+    token_batch batch, threaded_batch;
+    double batch_ns = elapsed_ns([&]() { batch = the_lexer.lexer_batch(inputs); });
+    thread_pool pool{4};
+    double threaded_ns = elapsed_ns([&]() { threaded_batch = the_lexer.lexer_batch(inputs, pool); });
+
+    bool same = batch.input_start.size() == inputs.size() + 1 &&
+                threaded_batch.input_start.size() == inputs.size() + 1;
+    for (std::size_t i = 0; same && i < inputs.size(); ++i) {
+        same = same_tokens(batch, i, per_call.at(i)) && same_tokens(threaded_batch, i, per_call.at(i));
+    }
+
+    std::cout << "per-call lexer: " << per_call_ns / static_cast<double>(input_bytes) << " ns/byte" << std::endl;
+    std::cout << "batch lexer: " << batch_ns / static_cast<double>(input_bytes) << " ns/byte" << std::endl;
+    std::cout << "batch lexer, 4 threads: " << threaded_ns / static_cast<double>(input_bytes) << " ns/byte"
+              << std::endl;
+    std::cout << "same tokens: " << std::boolalpha << same << std::endl;
+}
+
+void test_number_lexer() {
+    number_lexer_type the_lexer;
+
+    const std::string number_str = "0x1f,017,42,0,3.25e-4f,.5,15.f,1e-22,123456789012345678901234,"
+                                   "1e400,18446744073709551616,.,.f,.e5";
+    std::cout << number_str << std::endl;
+    for (auto &t: the_lexer.lexer_with_values(number_str)) {
+        if (auto *i = std::get_if<std::uint64_t>(&t.token_number)) {
+            std::cout << t.token_string << " -> " << *i << std::endl;
+        } else if (auto *d = std::get_if<double>(&t.token_number)) {
+            std::cout << t.token_string << " -> " << *d << std::endl;
+        } else if (t.token_string != ",") {
+            std::cout << t.token_string << " -> not decoded" << std::endl;
+        }
+    }
+    std::cout << std::endl;
+}
+
+void bench_number_lexer() {
+    number_lexer_type the_lexer;
+
+    // rows of the numeric columns of a CSV file
+    std::string input;
+    std::mt19937 rng{20261019};
+    std::uniform_int_distribution<std::uint32_t> id{0, 1000000};
+    std::uniform_real_distribution<double> price{0, 1000};
+    while (input.size() < (1 << 18)) {
+        input += std::to_string(id(rng)) + ", " + std::to_string(price(rng)) + ", " +
+                 std::to_string(price(rng) * 1e-6) + "\n";
+    }
+
+    // both sides build the same tokens, the commas included
+    const std::size_t comma_id = the_lexer.index_of<t_terminate_expr<','>>(),
+            integer_id = the_lexer.index_of<t_integer_reg>(), float_id = the_lexer.index_of<t_float_reg>();
+    std::vector<number_type> reparsed, decoded;
+    double reparse_ns = ns_per_byte([&](const std::string &sv) {
+        reparsed.clear();
+        for (auto &t: the_lexer.lexer_filtered(sv, {comma_id, integer_id, float_id})) {
+            if (t.token_id == integer_id) {
+                reparsed.emplace_back(std::strtoull(t.token_string.c_str(), nullptr, 0));
+            } else if (t.token_id == float_id) {
+                reparsed.emplace_back(std::strtod(t.token_string.c_str(), nullptr));
+            }
+        }
+    }, input, 8);
+    double decode_ns = ns_per_byte([&](const std::string &sv) {
+        decoded.clear();
+        for (auto &t: the_lexer.lexer_with_values(sv)) {
+            if (t.token_id != comma_id) {
+                decoded.push_back(t.token_number);
+            }
+        }
+    }, input, 8);
+
+    std::cout << "lex, then strtod: " << reparse_ns << " ns/byte" << std::endl;
+    std::cout << "decoded while lexing: " << decode_ns << " ns/byte" << std::endl;
+    std::cout << "same values: " << std::boolalpha << (reparsed == decoded) << std::endl;
+}
+
+void test_line_index() {
+    test_lexer_type the_lexer;
+    auto input = multi_line_input(1 << 12);
+    auto tokens = the_lexer.lexer(input);
+
+    // the whole input at once, and in chunks of random sizes
+    line_index whole{input}, chunked;
+    std::mt19937 rng{20261019};
+    std::uniform_int_distribution<std::size_t> chunk_size{0, 100};
+    std::size_t token_ix = 0;
+    bool same = true;
+    for (std::size_t chunk_start = 0; chunk_start < input.size();) {
+        std::size_t size = std::min(chunk_size(rng), input.size() - chunk_start);
+        chunked.append(std::string_view{input}.substr(chunk_start, size));
+        chunk_start += size;
+        // the tokens started in the chunks appended so far
+        for (; token_ix < tokens.size() && tokens.at(token_ix).token_start < chunk_start; ++token_ix) {
+            auto expected = rescan_position(input, tokens.at(token_ix).token_start);
+            same = same && whole.position(tokens.at(token_ix).token_start) == expected &&
+                   chunked.position(tokens.at(token_ix).token_start) == expected;
+        }
+    }
+    same = same && whole.position(input.size()) == rescan_position(input, input.size());
+
+    auto [line, column] = whole.position(tokens.at(20).token_start);
+    std::cout << tokens.at(20).to_string() << " at line " << line << ", column " << column << std::endl;
+    std::cout << "same positions: " << std::boolalpha << same << std::endl << std::endl;
+}
+
+void bench_line_index() {
+    test_lexer_type the_lexer;
+    auto input = multi_line_input(1 << 16);
+    auto tokens = the_lexer.lexer(input);
+
+    double lexer_ns = ns_per_byte([&](const std::string &sv) { return the_lexer.lexer(sv); }, input, 1);
+    double build_ns = ns_per_byte([](const std::string &sv) {
+        line_index index{sv};
+        return index.position(sv.size());
+    }, input, 8);
+
+    // positions of every token by the index, and of a sample of the tokens by rescanning
+    const std::size_t sample_step = 64;
+    std::vector<std::tuple<std::size_t, std::size_t>> index_positions, rescan_positions;
+    double index_ns = ns_per_byte([&](const std::string &sv) {
+        line_index index{sv};
+        for (std::size_t i = 0; i < tokens.size(); ++i) {
+            auto position = index.position(tokens.at(i).token_start);
+            if (i % sample_step == 0) {
+                index_positions.push_back(position);
+            }
+        }
+    }, input, 1);
+    double rescan_ns = ns_per_byte([&](const std::string &sv) {
+        for (std::size_t i = 0; i < tokens.size(); i += sample_step) {
+            rescan_positions.push_back(rescan_position(sv, tokens.at(i).token_start));
+        }
+    }, input, 1) * sample_step;
+
+    std::cout << "interpreted lexer: " << lexer_ns << " ns/byte" << std::endl;
+    std::cout << "line index, built and queried at the end: " << build_ns << " ns/byte" << std::endl;
+    std::cout << "positions of " << tokens.size() << " tokens by the line index: " << index_ns << " ns/byte"
+              << std::endl;
+    std::cout << "positions by rescanning, extrapolated: " << rescan_ns << " ns/byte" << std::endl;
+    std::cout << "same positions: " << std::boolalpha << (index_positions == rescan_positions) << std::endl;
+}
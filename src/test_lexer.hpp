@@ -0,0 +1,44 @@
+#pragma once
+
+#include "t_lexer.hpp"
+
+// rule set shared by the tests and the lexer generator
+using test_lexer_type = lexer0::t_lexer<
+        lexer0::t_terminate_expr<';'>,
+        lexer0::t_terminate_expr<':'>,
+        lexer0::t_terminate_expr<','>,
+        lexer0::t_terminate_expr<'='>,
+        lexer0::t_terminate_expr<'('>,
+        lexer0::t_terminate_expr<')'>,
+        lexer0::t_terminate_expr<'+'>,
+        lexer0::t_terminate_expr<'-'>,
+        lexer0::t_terminate_expr<'*'>,
+        lexer0::t_terminate_expr<'/'>,
+        lexer0::t_c_identifier_reg,
+        lexer0::t_float_reg,
+        lexer0::t_blank_reg
+>;
+
+// test_lexer_type with the blanks dropped
+using test_skip_lexer_type = lexer0::t_lexer<
+        lexer0::t_terminate_expr<';'>,
+        lexer0::t_terminate_expr<':'>,
+        lexer0::t_terminate_expr<','>,
+        lexer0::t_terminate_expr<'='>,
+        lexer0::t_terminate_expr<'('>,
+        lexer0::t_terminate_expr<')'>,
+        lexer0::t_terminate_expr<'+'>,
+        lexer0::t_terminate_expr<'-'>,
+        lexer0::t_terminate_expr<'*'>,
+        lexer0::t_terminate_expr<'/'>,
+        lexer0::t_c_identifier_reg,
+        lexer0::t_float_reg,
+        lexer0::t_skip<lexer0::t_blank_reg>
+>;
+
+// direct-coded lexers of test_lexer_type and test_skip_lexer_type, generated by gen_test_lexer
+std::vector<lexer0::token> test_lexer_direct(const std::string &sv);
+std::vector<lexer0::token> test_skip_lexer_direct(const std::string &sv);
+
+// automaton of random keywords and blanks, with an input of the keywords separated by blanks
+std::tuple<lexer0::fused_dfa, std::string> keyword_grammar(std::size_t keyword_size, std::size_t input_size);
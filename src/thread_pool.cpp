@@ -0,0 +1,68 @@
+#include "thread_pool.hpp"
+
+namespace lexer0 {
+
+    thread_pool::thread_pool(std::size_t thread_size) {
+        for (std::size_t t = 1; t < thread_size; ++t) {
+            workers.emplace_back([this]() { work(); });
+        }
+    }
+
+    thread_pool::~thread_pool() {
+        {
+            std::lock_guard lock{mutex};
+            stopping = true;
+        }
+        task_ready.notify_all();
+        // joined before the members they use are destroyed
+        workers.clear();
+    }
+
+    void thread_pool::work() {
+        std::size_t seen = 0;
+        std::unique_lock lock{mutex};
+        while (true) {
+            task_ready.wait(lock, [&]() { return stopping || generation != seen; });
+            if (stopping) {
+                return;
+            }
+            seen = generation;
+            // woken after the run is over, nothing is left
+            if (!task) {
+                continue;
+            }
+            ++busy;
+            drain(lock);
+            if (--busy == 0) {
+                task_done.notify_all();
+            }
+        }
+    }
+
+    void thread_pool::drain(std::unique_lock<std::mutex> &lock) {
+        while (next_ix < task_size) {
+            std::size_t ix = next_ix++;
+            auto &f = *task;
+            lock.unlock();
+            f(ix);
+            lock.lock();
+        }
+    }
+
+    void thread_pool::run(std::size_t size, const std::function<void(std::size_t)> &f) {
+        std::unique_lock lock{mutex};
+        task = &f;
+        task_size = size;
+        next_ix = 0;
+        ++generation;
+        task_ready.notify_all();
+        drain(lock);
+        task_done.wait(lock, [this]() { return busy == 0; });
+        task = nullptr;
+    }
+
+    std::size_t thread_pool::thread_size() const {
+        return workers.size() + 1;
+    }
+
+}
@@ -0,0 +1,21 @@
+#include "reg_expr.hpp"
+
+namespace lexer0 {
+
+    utf8_range_expr::utf8_range_expr(char32_t lo, char32_t hi) : lo_codepoint{lo}, hi_codepoint{hi} {
+        assert(lo <= hi && hi <= utf8_max_codepoint);
+    }
+
+    std::size_t utf8_range_expr::get_size(bool force) {
+        if (force || fa_size == 0) {
+            return fa_size = utf8_nfa_size(lo_codepoint, hi_codepoint);
+        } else {
+            return fa_size;
+        }
+    }
+
+    void utf8_range_expr::create_nfa(nfa &fa, std::size_t zero_status) const {
+        utf8_create_nfa(fa, zero_status, lo_codepoint, hi_codepoint);
+    }
+
+}